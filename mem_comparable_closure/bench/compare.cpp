@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+#include "mem_comparable_closure.hpp"
+#include "mem_comparable_vector.hpp"
+
+// compares is_identical on vectors of small structs with padding
+// with a hand written field by field comparison.
+
+namespace {
+  struct Particle{
+    char kind;
+    int x;
+    int y;
+    short charge;
+  };
+
+  std::vector<Particle> make_particles(std::size_t size){
+    std::vector<Particle> particles(size);
+    for (std::size_t i = 0; i< size; ++i){
+      particles[i] = Particle{'p', static_cast<int>(i), static_cast<int>(2*i), 1};
+    };
+    return particles;
+  };
+}
+
+static void BM_hand_written_particles(benchmark::State& state){
+  auto particles1 = make_particles(state.range(0));
+  auto particles2 = make_particles(state.range(0));
+  for (auto _ : state){
+    bool identical = particles1.size() == particles2.size()
+      and std::equal(particles1.begin(), particles1.end(), particles2.begin(),
+		     [](const Particle& a, const Particle& b){
+		       return a.kind == b.kind and a.x == b.x and a.y == b.y and a.charge == b.charge;
+		     });
+    benchmark::DoNotOptimize(identical);
+  };
+  state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(Particle)*2);
+}
+BENCHMARK(BM_hand_written_particles)->Arg(1000)->Arg(100000);
+
+static void BM_is_identical_particles(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto particles1 = make_particles(state.range(0));
+  auto particles2 = make_particles(state.range(0));
+  for (auto _ : state){
+    benchmark::DoNotOptimize(is_identical(particles1, particles2));
+  };
+  state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(Particle)*2);
+}
+BENCHMARK(BM_is_identical_particles)->Arg(1000)->Arg(100000);
+
+namespace {
+  // the same fields behind get_member_access
+  class MemberParticle{
+  public:
+    MemberParticle() = default;
+    explicit MemberParticle(const Particle& particle)
+      :kind(particle.kind), x(particle.x), y(particle.y), charge(particle.charge){};
+    std::tuple<const char*, const int*, const int*, const short*> get_member_access()const{
+      return {&(this->kind), &(this->x), &(this->y), &(this->charge)};
+    };
+  private:
+    char kind = 0;
+    int x = 0;
+    int y = 0;
+    short charge = 0;
+  };
+
+  std::vector<MemberParticle> make_member_particles(std::size_t size){
+    auto particles = make_particles(size);
+    return std::vector<MemberParticle>(particles.begin(), particles.end());
+  };
+}
+
+template<>
+struct ::mem_comparable_closure::concepts::is_member_accessible<MemberParticle> : std::true_type{};
+
+static void BM_is_identical_member_particles(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto particles1 = make_member_particles(state.range(0));
+  auto particles2 = make_member_particles(state.range(0));
+  for (auto _ : state){
+    benchmark::DoNotOptimize(is_identical(particles1, particles2));
+  };
+  state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(MemberParticle)*2);
+}
+BENCHMARK(BM_is_identical_member_particles)->Arg(1000)->Arg(100000);
+
+namespace {
+  int wrap(mem_comparable_closure::Function<int, int> inner, int x){
+    return inner(x) + 1;
+  };
+
+  int identity(int x){ return x;};
+
+  mem_comparable_closure::Function<int, int> make_nested(std::size_t depth){
+    using namespace mem_comparable_closure;
+    auto fun = closure_from_fp(identity).as_fun();
+    for (std::size_t i = 0; i< depth; ++i){
+      fun = closure_from_fp(wrap).bind(std::move(fun)).as_fun();
+    };
+    return fun;
+  };
+}
+
+// Functions bound in Functions, one level per Arg
+static void BM_is_identical_nested_functions(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto fun1 = make_nested(state.range(0));
+  auto fun2 = make_nested(state.range(0));
+  for (auto _ : state){
+    benchmark::DoNotOptimize(is_identical(fun1, fun2));
+  };
+  state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+BENCHMARK(BM_is_identical_nested_functions)->Arg(10)->Arg(1000)->Arg(10000);
@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include "../test/mem_comparable_fuzz.hpp"
+
+// comparisons per second for random closures (see test/mem_comparable_fuzz.hpp),
+//   one benchmark per kind of the outermost closure.
+
+namespace {
+  constexpr std::size_t pair_count = 64;
+
+  struct Pairs{
+    std::vector<fuzz::function_t> funs1;
+    std::vector<fuzz::function_t> funs2;
+  };
+
+  // identical pairs or pairs with a single mutated draw
+  Pairs make_pairs(fuzz::Kind kind, bool mutate){
+    Pairs pairs;
+    std::mt19937_64 rng(static_cast<std::uint64_t>(kind));
+    for (std::size_t i = 0; i< pair_count; ++i){
+      const std::uint64_t seed = rng();
+      fuzz::Generator generator1(seed);
+      pairs.funs1.push_back(generator1.generate(fuzz::Generator::max_depth, kind).first);
+      const std::size_t mutate_at = mutate ?
+	rng() % generator1.get_draw_count() : fuzz::Generator::no_mutation;
+      fuzz::Generator generator2(seed, mutate_at);
+      pairs.funs2.push_back(generator2.generate(fuzz::Generator::max_depth, kind).first);
+    };
+    return pairs;
+  };
+
+  void compare_pairs(benchmark::State& state, const Pairs& pairs){
+    using namespace mem_comparable_closure;
+    for (auto _ : state){
+      for (std::size_t i = 0; i< pair_count; ++i){
+	benchmark::DoNotOptimize(is_identical(pairs.funs1[i], pairs.funs2[i]));
+      };
+    };
+    state.SetItemsProcessed(state.iterations()*pair_count);
+  };
+}
+
+static void BM_fuzz_identical(benchmark::State& state){
+  const auto pairs = make_pairs(static_cast<fuzz::Kind>(state.range(0)), false);
+  compare_pairs(state, pairs);
+}
+BENCHMARK(BM_fuzz_identical)->ArgName("kind")->DenseRange(0, static_cast<int>(fuzz::Kind::count)-1);
+
+static void BM_fuzz_mutated(benchmark::State& state){
+  const auto pairs = make_pairs(static_cast<fuzz::Kind>(state.range(0)), true);
+  compare_pairs(state, pairs);
+}
+BENCHMARK(BM_fuzz_mutated)->ArgName("kind")->DenseRange(0, static_cast<int>(fuzz::Kind::count)-1);
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include "mem_comparable_closure.hpp"
+#include "mem_comparable_vector.hpp"
+
+// compares calling a Closure / Function with calling a hand written lambda
+// which captures the same values and the same function pointer.
+
+namespace {
+  int combine(int a, int b, int c, int d){
+    return a*3 + b*5 + c*7 + d;
+  };
+
+  int sum(std::vector<int> values, int offset){
+    int result = offset;
+    for (int value : values) result += value;
+    return result;
+  };
+}
+
+static void BM_lambda_ints(benchmark::State& state){
+  int (*fn)(int, int, int, int) = combine;
+  int a = 1, b = 2, c = 3;
+  auto lambda = [fn, a, b, c](int d){ return fn(a, b, c, d); };
+  int d = 0;
+  for (auto _ : state){
+    benchmark::DoNotOptimize(lambda(d++));
+  };
+}
+BENCHMARK(BM_lambda_ints);
+
+static void BM_closure_ints(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto closure = closure_from_fp(combine).bind(1).bind(2).bind(3);
+  int d = 0;
+  for (auto _ : state){
+    benchmark::DoNotOptimize(closure(d++));
+  };
+}
+BENCHMARK(BM_closure_ints);
+
+static void BM_function_ints(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto fun = closure_from_fp(combine).bind(1).bind(2).bind(3).as_fun();
+  int d = 0;
+  for (auto _ : state){
+    benchmark::DoNotOptimize(fun(d++));
+  };
+}
+BENCHMARK(BM_function_ints);
+
+static void BM_lambda_vector(benchmark::State& state){
+  int (*fn)(std::vector<int>, int) = sum;
+  std::vector<int> values(state.range(0), 1);
+  auto lambda = [fn, values](int offset){ return fn(values, offset); };
+  int offset = 0;
+  for (auto _ : state){
+    benchmark::DoNotOptimize(lambda(offset++));
+  };
+}
+BENCHMARK(BM_lambda_vector)->Arg(16)->Arg(1024);
+
+static void BM_closure_vector(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto closure = closure_from_fp(sum).bind(std::vector<int>(state.range(0), 1));
+  int offset = 0;
+  for (auto _ : state){
+    benchmark::DoNotOptimize(closure(offset++));
+  };
+}
+BENCHMARK(BM_closure_vector)->Arg(16)->Arg(1024);
+
+static void BM_function_vector(benchmark::State& state){
+  using namespace mem_comparable_closure;
+  auto fun = closure_from_fp(sum).bind(std::vector<int>(state.range(0), 1)).as_fun();
+  int offset = 0;
+  for (auto _ : state){
+    benchmark::DoNotOptimize(fun(offset++));
+  };
+}
+BENCHMARK(BM_function_vector)->Arg(16)->Arg(1024);
+
+BENCHMARK_MAIN();
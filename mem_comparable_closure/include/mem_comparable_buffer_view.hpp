@@ -0,0 +1,153 @@
+#ifndef MEM_COMPARABLE_BUFFER_VIEW_HPP
+#define MEM_COMPARABLE_BUFFER_VIEW_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <atomic>
+
+// BufferView
+namespace mem_comparable_closure{
+  struct BufferViewCompareIterator{
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    std::size_t next_element;
+  };
+
+  // BufferView is a non-owning view of an immutable buffer (a pointer and a size).
+  //   it can be bound into a closure without copying the buffer.
+  //   the buffer has to outlive the view and every closure it is bound to
+  //   and must not change while it is viewed.
+  //
+  //   a view is compared by its size, then by the identity of the buffer
+  //   (see MemCompareInfo::identity_skip_fn) and only for different buffers by the elements.
+  //
+  //   the fingerprint is the structural_hash of the elements. it is computed on first use
+  //   and kept by the view and its copies afterwards. that first use reads the whole buffer
+  //   (about 2 ms per MB of ints) and binding the view into a closure is one,
+  //   so bind copies of a view whose fingerprint is known to bind a buffer more than once.
+  template<class T>
+  class BufferView{
+  public:
+    BufferView() = default;
+    BufferView(const T* data, std::size_t size):data(data), size(size){
+      assert(data or size == 0);
+    };
+    BufferView(const BufferView<T>& other):
+      data(other.data),
+      size(other.size),
+      fingerprint(other.fingerprint.load(std::memory_order_relaxed)){};
+    BufferView<T>& operator=(const BufferView<T>& other){
+      this->data = other.data;
+      this->size = other.size;
+      this->fingerprint.store(other.fingerprint.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      return *this;
+    };
+
+    const T* get_data()const{return this->data;};
+    std::size_t get_size()const{return this->size;};
+    bool is_empty()const{return this->size == 0;};
+
+    const T& operator[](std::size_t i)const{
+      assert(i < this->size);
+      return this->data[i];
+    };
+    const T* begin()const{return this->data;};
+    const T* end()const{return this->data+this->size;};
+
+    std::size_t get_fingerprint()const{
+      std::size_t fingerprint = this->fingerprint.load(std::memory_order_relaxed);
+      if (fingerprint == 0){
+	fingerprint = structural_hash(*this);
+	this->fingerprint.store(fingerprint, std::memory_order_relaxed);
+      };
+      return fingerprint;
+    };
+
+    MemCompareInfo get_mem_compare_info(const void* next_obj,
+					mem_compare_continuation_fn_t continuation,
+					IteratorStack& stack)const{
+      static_assert(concepts::is_transparent<T>::value, "the elements of this view are not transparent");
+      new (stack.get_new<BufferViewCompareIterator>()) BufferViewCompareIterator{
+	.next_obj = next_obj,
+	  .continuation_fn = continuation,
+	  .next_element = 0};
+      return MemCompareInfo{
+	.next_obj = static_cast<const void*>(this),
+	  .continuation_fn = continue_identity_mem_compare_info,
+	  .obj  = static_cast<const void*>(&(this->size)),
+	  .size =sizeof(std::size_t)
+	  };
+    };
+
+  private:
+    static MemCompareInfo continue_identity_mem_compare_info(IteratorStack& stack,
+							     const void* obj){
+      auto self = static_cast<const BufferView<T>*>(obj);
+      if (self->size == 0) return end_mem_compare_info(stack, obj);
+      return MemCompareInfo{
+	.next_obj = obj,
+	  .continuation_fn = continue_elements_mem_compare_info,
+	  .obj  = static_cast<const void*>(self->data),
+	  .size = 0,
+	  .identity_skip_fn = end_mem_compare_info
+	  };
+    };
+
+    static MemCompareInfo continue_elements_mem_compare_info(IteratorStack& stack,
+							     const void* obj){
+      auto self = static_cast<const BufferView<T>*>(obj);
+      if constexpr (concepts::is_trivial<T>::value){
+	return MemCompareInfo{
+	  .next_obj = obj,
+	    .continuation_fn = end_mem_compare_info,
+	    .obj  = static_cast<const void*>(self->data),
+	    .size = self->size*sizeof(T)
+	    };
+      } else {
+	auto& it = stack.get_last<BufferViewCompareIterator>();
+	if (it.next_element == self->size) return end_mem_compare_info(stack, obj);
+	const std::size_t this_element = it.next_element;
+	it.next_element = it.next_element+1;
+	return algorithm::dispatch_mem_compare_info(self->data+this_element,
+						    obj,
+						    continue_elements_mem_compare_info,
+						    stack);
+      };
+    };
+
+    static MemCompareInfo end_mem_compare_info(IteratorStack& stack,
+					       const void* ){
+      auto saved = stack.pop_last<BufferViewCompareIterator>();
+      return MemCompareInfo{
+	.next_obj = saved.next_obj,
+	  .continuation_fn = saved.continuation_fn,
+	  .obj  = nullptr,
+	  .size =0
+	  };
+    };
+
+    const T* data = nullptr;
+    std::size_t size = 0;
+    // 0 until computed, threads racing to compute it store the same value
+    mutable std::atomic<std::size_t> fingerprint{0};
+  };
+
+  // the elements have to be transparent, too (checked when a view is compared)
+  template<class T>
+  struct concepts::is_protocol_compatible<BufferView<T>>
+    : std::true_type{ };
+
+  // a view of a contiguous container (e.g. a std::vector or a std::array)
+  template<class C>
+  decltype(auto) make_buffer_view(const C& container){
+    using element_t = typename std::remove_cv<
+      typename std::remove_pointer<decltype(container.data())>::type>::type;
+    return BufferView<element_t>(container.data(), container.size());
+  };
+
+  // a view of a temporary would dangle
+  template<class C>
+  void make_buffer_view(const C&& container) = delete;
+}
+
+#endif //MEM_COMPARABLE_BUFFER_VIEW_HPP
@@ -9,6 +9,13 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <cstdint>
+#include <climits>
+#include <limits>
+#include <atomic>
+#include <array>
+#include <stdexcept>
+#include <algorithm>
 /*
  *  Ok a little explanation: 
  *   FunctionSignature is simply a holder class for the variadic Arguments, to separate them in variadic argument lists of other classes
@@ -21,7 +28,8 @@
  * 
  *   Fun<return_t, Args_t...>
  *     this class represents a closure where the closed over elements are erased.
- *     it holds a pointer to a ClosureBase / ClosureHolder
+ *     it holds a pointer to a ref counted ClosureContainer and a manual vtable
+ *     (or to a ClosureBase / ClosureHolder)
  *
  *
  *     naming for the internal classes is not very intuitive.
@@ -60,13 +68,226 @@
 
 
 
+// aggregate reflection
+namespace mem_comparable_closure {
+  namespace reflection {
+    // the maximum number of fields of a reflected aggregate
+    constexpr std::size_t max_field_count = 16;
+
+    namespace detail {
+      // converts to any field type.
+      //   only used in unevaluated context to count the fields of an aggregate.
+      struct any_field{
+	template<class U>
+	operator U()const;
+      };
+
+      // converts only to a base class of T.
+      //   T can be brace initialized with it, if its first element is a base.
+      //   (conservative: a first member constructible from anything counts as a base too)
+      template<class T>
+      struct any_base{
+	template<class U, class = typename std::enable_if<
+			    std::is_base_of<U, T>::value and not std::is_same<U, T>::value>::type>
+	operator U()const;
+      };
+
+      template<class T, class indices, class enable = void>
+      struct is_brace_constructible : std::false_type{};
+
+      template<class T, std::size_t ...i>
+      struct is_brace_constructible<T, std::index_sequence<i...>,
+				    std::void_t<decltype(T{ (static_cast<void>(i), any_field{})... })>>
+	: std::true_type{};
+
+      template<class T, class enable = void>
+      struct has_base : std::false_type{};
+
+      template<class T>
+      struct has_base<T, std::void_t<decltype(T{ any_base<T>{} })>> : std::true_type{};
+
+      // T can be initialized with n empty braces, one per direct element.
+      //   an empty brace is never elided, so arrays count as a single element.
+      template<class T, std::size_t n, class enable = void>
+      struct is_brace_list_constructible : std::false_type{};
+
+      // binds the n fields of an aggregate
+      template<std::size_t n>
+      struct field_binder;
+
+#define MEM_COMPARABLE_FIELDS_1 m0
+#define MEM_COMPARABLE_FIELDS_2 MEM_COMPARABLE_FIELDS_1, m1
+#define MEM_COMPARABLE_FIELDS_3 MEM_COMPARABLE_FIELDS_2, m2
+#define MEM_COMPARABLE_FIELDS_4 MEM_COMPARABLE_FIELDS_3, m3
+#define MEM_COMPARABLE_FIELDS_5 MEM_COMPARABLE_FIELDS_4, m4
+#define MEM_COMPARABLE_FIELDS_6 MEM_COMPARABLE_FIELDS_5, m5
+#define MEM_COMPARABLE_FIELDS_7 MEM_COMPARABLE_FIELDS_6, m6
+#define MEM_COMPARABLE_FIELDS_8 MEM_COMPARABLE_FIELDS_7, m7
+#define MEM_COMPARABLE_FIELDS_9 MEM_COMPARABLE_FIELDS_8, m8
+#define MEM_COMPARABLE_FIELDS_10 MEM_COMPARABLE_FIELDS_9, m9
+#define MEM_COMPARABLE_FIELDS_11 MEM_COMPARABLE_FIELDS_10, m10
+#define MEM_COMPARABLE_FIELDS_12 MEM_COMPARABLE_FIELDS_11, m11
+#define MEM_COMPARABLE_FIELDS_13 MEM_COMPARABLE_FIELDS_12, m12
+#define MEM_COMPARABLE_FIELDS_14 MEM_COMPARABLE_FIELDS_13, m13
+#define MEM_COMPARABLE_FIELDS_15 MEM_COMPARABLE_FIELDS_14, m14
+#define MEM_COMPARABLE_FIELDS_16 MEM_COMPARABLE_FIELDS_15, m15
+#define MEM_COMPARABLE_FIELDS_17 MEM_COMPARABLE_FIELDS_16, m16
+
+#define MEM_COMPARABLE_BRACES_1 {}
+#define MEM_COMPARABLE_BRACES_2 MEM_COMPARABLE_BRACES_1, {}
+#define MEM_COMPARABLE_BRACES_3 MEM_COMPARABLE_BRACES_2, {}
+#define MEM_COMPARABLE_BRACES_4 MEM_COMPARABLE_BRACES_3, {}
+#define MEM_COMPARABLE_BRACES_5 MEM_COMPARABLE_BRACES_4, {}
+#define MEM_COMPARABLE_BRACES_6 MEM_COMPARABLE_BRACES_5, {}
+#define MEM_COMPARABLE_BRACES_7 MEM_COMPARABLE_BRACES_6, {}
+#define MEM_COMPARABLE_BRACES_8 MEM_COMPARABLE_BRACES_7, {}
+#define MEM_COMPARABLE_BRACES_9 MEM_COMPARABLE_BRACES_8, {}
+#define MEM_COMPARABLE_BRACES_10 MEM_COMPARABLE_BRACES_9, {}
+#define MEM_COMPARABLE_BRACES_11 MEM_COMPARABLE_BRACES_10, {}
+#define MEM_COMPARABLE_BRACES_12 MEM_COMPARABLE_BRACES_11, {}
+#define MEM_COMPARABLE_BRACES_13 MEM_COMPARABLE_BRACES_12, {}
+#define MEM_COMPARABLE_BRACES_14 MEM_COMPARABLE_BRACES_13, {}
+#define MEM_COMPARABLE_BRACES_15 MEM_COMPARABLE_BRACES_14, {}
+#define MEM_COMPARABLE_BRACES_16 MEM_COMPARABLE_BRACES_15, {}
+#define MEM_COMPARABLE_BRACES_17 MEM_COMPARABLE_BRACES_16, {}
+
+#define MEM_COMPARABLE_REFLECT_FIELDS(n)				\
+      template<class T>							\
+      struct is_brace_list_constructible<T, n, std::void_t<decltype(T{ MEM_COMPARABLE_BRACES_##n })>> \
+	: std::true_type{};						\
+									\
+      template<>							\
+      struct field_binder<n>{						\
+	template<class T>						\
+	static auto get(const T& obj){					\
+	  const auto& [MEM_COMPARABLE_FIELDS_##n] = obj;		\
+	  return [](const auto& ...m){ return std::make_tuple(&m...); }(MEM_COMPARABLE_FIELDS_##n); \
+	};								\
+      };
+
+      MEM_COMPARABLE_REFLECT_FIELDS(1)
+      MEM_COMPARABLE_REFLECT_FIELDS(2)
+      MEM_COMPARABLE_REFLECT_FIELDS(3)
+      MEM_COMPARABLE_REFLECT_FIELDS(4)
+      MEM_COMPARABLE_REFLECT_FIELDS(5)
+      MEM_COMPARABLE_REFLECT_FIELDS(6)
+      MEM_COMPARABLE_REFLECT_FIELDS(7)
+      MEM_COMPARABLE_REFLECT_FIELDS(8)
+      MEM_COMPARABLE_REFLECT_FIELDS(9)
+      MEM_COMPARABLE_REFLECT_FIELDS(10)
+      MEM_COMPARABLE_REFLECT_FIELDS(11)
+      MEM_COMPARABLE_REFLECT_FIELDS(12)
+      MEM_COMPARABLE_REFLECT_FIELDS(13)
+      MEM_COMPARABLE_REFLECT_FIELDS(14)
+      MEM_COMPARABLE_REFLECT_FIELDS(15)
+      MEM_COMPARABLE_REFLECT_FIELDS(16)
+      MEM_COMPARABLE_REFLECT_FIELDS(17)
+
+#undef MEM_COMPARABLE_REFLECT_FIELDS
+#undef MEM_COMPARABLE_BRACES_17
+#undef MEM_COMPARABLE_BRACES_16
+#undef MEM_COMPARABLE_BRACES_15
+#undef MEM_COMPARABLE_BRACES_14
+#undef MEM_COMPARABLE_BRACES_13
+#undef MEM_COMPARABLE_BRACES_12
+#undef MEM_COMPARABLE_BRACES_11
+#undef MEM_COMPARABLE_BRACES_10
+#undef MEM_COMPARABLE_BRACES_9
+#undef MEM_COMPARABLE_BRACES_8
+#undef MEM_COMPARABLE_BRACES_7
+#undef MEM_COMPARABLE_BRACES_6
+#undef MEM_COMPARABLE_BRACES_5
+#undef MEM_COMPARABLE_BRACES_4
+#undef MEM_COMPARABLE_BRACES_3
+#undef MEM_COMPARABLE_BRACES_2
+#undef MEM_COMPARABLE_BRACES_1
+#undef MEM_COMPARABLE_FIELDS_17
+#undef MEM_COMPARABLE_FIELDS_16
+#undef MEM_COMPARABLE_FIELDS_15
+#undef MEM_COMPARABLE_FIELDS_14
+#undef MEM_COMPARABLE_FIELDS_13
+#undef MEM_COMPARABLE_FIELDS_12
+#undef MEM_COMPARABLE_FIELDS_11
+#undef MEM_COMPARABLE_FIELDS_10
+#undef MEM_COMPARABLE_FIELDS_9
+#undef MEM_COMPARABLE_FIELDS_8
+#undef MEM_COMPARABLE_FIELDS_7
+#undef MEM_COMPARABLE_FIELDS_6
+#undef MEM_COMPARABLE_FIELDS_5
+#undef MEM_COMPARABLE_FIELDS_4
+#undef MEM_COMPARABLE_FIELDS_3
+#undef MEM_COMPARABLE_FIELDS_2
+#undef MEM_COMPARABLE_FIELDS_1
+    }
+
+    // the number of fields of the aggregate T,
+    //   the highest number of initializers T can be brace initialized with.
+    //   max_field_count+1 means there are too many fields.
+    //   note: array members are counted per element (brace elision).
+    template<class T, std::size_t n = max_field_count+1>
+    constexpr std::size_t field_count(){
+      if constexpr (n == 0){
+	return 0;
+      } else if constexpr (detail::is_brace_constructible<T, std::make_index_sequence<n>>::value){
+	return n;
+      } else {
+	return field_count<T, n-1>();
+      };
+    };
+
+    // the number of direct elements (bases and members) of the aggregate T.
+    //   arrays count as one element.
+    template<class T, std::size_t n = max_field_count+1>
+    constexpr std::size_t element_count(){
+      if constexpr (n == 0){
+	return 0;
+      } else if constexpr (detail::is_brace_list_constructible<T, n>::value){
+	return n;
+      } else {
+	return element_count<T, n-1>();
+      };
+    };
+
+    // the fields of T can be bound without an error:
+    //   no base classes and as many fields as elements.
+    //   (an array member with more than one element has more fields than elements)
+    template<class T>
+    constexpr bool is_bindable(){
+      constexpr std::size_t n = field_count<T>();
+      return n > 0 and n <= max_field_count
+	and element_count<T>() == n
+	and not detail::has_base<T>::value;
+    };
+
+    // returns a std::tuple of pointers to the fields of the aggregate obj
+    //   (the same as get_member_access() would)
+    template<class T>
+    auto get_field_pointers(const T& obj){
+      static_assert(is_bindable<T>(), "unsupported aggregate");
+      return detail::field_binder<field_count<T>()>::get(obj);
+    };
+
+    template<class T>
+    using field_pointers_t = decltype(get_field_pointers(std::declval<const T&>()));
+
+    template<std::size_t i, class T>
+    using field_t = typename std::remove_const<
+      typename std::remove_pointer<
+	typename std::tuple_element<i, field_pointers_t<T>>::type
+	>::type
+      >::type;
+  }
+}
+
 // metaprogramming concepts
 namespace mem_comparable_closure {
   namespace  concepts {
     // note this is trivial in the mem_comparable_closure sense
     // a trivial type can be compared simply by memcmp'ing it.
     // so no padding, no pointers
-    template<class T>
+    //   types without padding and pointers are detected automatically (see below),
+    //   everything else has to be specialized by hand.
+    template<class T, class enable = void>
     struct is_trivial: std::false_type { };
 
     // a member_accessible type has a method get_members()
@@ -88,17 +309,191 @@ namespace mem_comparable_closure {
     struct is_specialized:std::false_type{};
 
     
+    // floating point types have no unique object representation
+    //   ( 0.0 == -0.0 but their bits differ, a NaN is never equal to itself),
+    //   so they are not covered by the automatic detection.
+    //   the float policy decides how a floating point type is compared:
+    //     bitwise: the bits are compared. 0.0 and -0.0 are different,
+    //              a NaN is identical to the same NaN.
+    //              this is what change detection needs.
+    //     reject: the type is not transparent.
+    //   structs containing floats have to be specialized by hand
+    //   or made member_accessible.
+    enum class FloatPolicy{ bitwise, reject };
+
+    template<class T>
+    struct float_policy : std::integral_constant<FloatPolicy, FloatPolicy::bitwise>{};
+
+    namespace detail{
+      // the x87 extended format has 80 value bits but sizeof(long double) is 12 or 16
+      template<class T>
+      constexpr bool has_padding_bits(){
+	return std::numeric_limits<T>::digits == 64 and sizeof(T)*CHAR_BIT > 80;
+      };
+
+      // a pointer_free type holds no pointers, neither itself nor in its fields.
+      //   classes are only inspected if they are aggregates
+      //   with at most max_field_count fields (array elements count individually),
+      //   all other classes are assumed to hold pointers.
+      template<class T, class enable = void>
+      struct is_pointer_free
+	: std::integral_constant<bool,
+				 std::is_scalar<T>::value
+				 and not std::is_pointer<T>::value
+				 and not std::is_member_pointer<T>::value>{};
+
+      template<class T, std::size_t N>
+      struct is_pointer_free<T[N]>: is_pointer_free<T>{};
+
+      // converts only to pointer_free types.
+      //   the conversion to other types is deleted instead of missing,
+      //   so a field holding pointers is not brace elided into.
+      struct pointer_free_field{
+	template<class U, typename std::enable_if<is_pointer_free<U>::value, int>::type = 0>
+	operator U()const;
+	template<class U, typename std::enable_if<not is_pointer_free<U>::value, int>::type = 0>
+	operator U()const = delete;
+      };
+
+      template<class T, class indices, class enable = void>
+      struct are_fields_pointer_free_impl : std::false_type{};
+
+      template<class T, std::size_t ...i>
+      struct are_fields_pointer_free_impl<T, std::index_sequence<i...>,
+					  std::void_t<decltype(T{ (static_cast<void>(i), pointer_free_field{})... })>>
+	: std::true_type{};
+
+      // the fields are only counted, when this is instantiated
+      template<class T>
+      struct are_fields_pointer_free
+	: std::conjunction<
+	std::bool_constant<(reflection::field_count<T>() <= reflection::max_field_count)>,
+	are_fields_pointer_free_impl<T, std::make_index_sequence<reflection::field_count<T>()>>
+	>{};
+
+      template<class T>
+      struct is_pointer_free<T, typename std::enable_if<std::is_class<T>::value>::type>
+	: std::conjunction<std::is_aggregate<T>,
+			   std::negation<std::is_union<T>>,
+			   are_fields_pointer_free<T>>{};
+
+      // a type is trivial without specialization, if it has no padding,
+      // holds no pointers (comparing the address is not what we want)
+      // and has no other way of being compared.
+      template<class T>
+      constexpr bool is_automatically_trivial(){
+	return std::conjunction<std::has_unique_object_representations<T>,
+				std::is_trivially_copyable<T>,
+				is_pointer_free<T>>::value
+	  and not is_member_accessible<T>::value
+	  and not is_protocol_compatible<T>::value
+	  and not is_specialized<T>::value;
+      };
+
+      template<class T>
+      constexpr bool is_bitwise_float(){
+	// numeric_limits can't be instantiated for every T (e.g. arrays)
+	if constexpr (std::is_floating_point<T>::value){
+	  return float_policy<T>::value == FloatPolicy::bitwise
+	    and not has_padding_bits<T>();
+	} else {
+	  return false;
+	};
+      };
+
+      // an array of trivial elements is trivial as a whole,
+      //   so it is compared as a single chunk of N*sizeof(T).
+      //   (std::array<T,0> still has a size of 1)
+      template<class T>
+      struct is_trivial_array: std::false_type{};
+
+      template<class T, std::size_t N>
+      struct is_trivial_array<T[N]>
+	: std::integral_constant<bool, (N > 0) and is_trivial<T>::value>{};
+
+      template<class T, std::size_t N>
+      struct is_trivial_array<std::array<T, N>>
+	: std::integral_constant<bool,
+				 (N > 0)
+				 and sizeof(std::array<T, N>) == N*sizeof(T)
+				 and is_trivial<T>::value>{};
+    }
+
+    // all other arrays are compared element by element
+    template<class T, std::size_t N>
+    struct is_specialized<T[N]>: std::negation<detail::is_trivial_array<T[N]>>{};
+
+    template<class T, std::size_t N>
+    struct is_specialized<std::array<T, N>>: std::negation<detail::is_trivial_array<std::array<T, N>>>{};
+
+    template<class T>
+    struct is_trivial<T, typename std::enable_if<
+			   detail::is_automatically_trivial<T>()
+			   or detail::is_bitwise_float<T>()
+			   or detail::is_trivial_array<T>::value
+			   >::type>: std::true_type{};
+
     // is tansparent  effectively alialises to true_type or false_type
     // this is different from check_transparency  
     template<class T, class enable = void>
     struct is_transparent : std::false_type{ };
 
+    namespace detail{
+      template<class T, class indices>
+      struct are_fields_transparent_impl;
+
+      template<class T, std::size_t ...i>
+      struct are_fields_transparent_impl<T, std::index_sequence<i...>>
+	: std::conjunction<is_transparent<reflection::field_t<i,T>>...>{};
+
+      // the fields are only counted, when this is instantiated
+      template<class T>
+      struct are_fields_transparent
+	: are_fields_transparent_impl<T, std::make_index_sequence<reflection::field_count<T>()>>{};
+
+      template<class T>
+      struct is_bindable
+	: std::integral_constant<bool, reflection::is_bindable<T>()>{};
+
+      // only instantiated for bindable T
+      template<class T, class indices>
+      struct has_array_fields_impl;
+
+      template<class T, std::size_t ...i>
+      struct has_array_fields_impl<T, std::index_sequence<i...>>
+	: std::disjunction<std::is_array<reflection::field_t<i,T>>...>{};
+
+      template<class T>
+      struct has_array_fields
+	: has_array_fields_impl<T, std::make_index_sequence<reflection::field_count<T>()>>{};
+    }
+
+    // an aggregate_reflectable type is an aggregate
+    // whose fields are transparent.
+    // it is compared like a member_accessible type, but needs no get_member_access().
+    //   only considered if the type has no other way of being compared.
+    //   note: aggregates with base classes or array members are not supported,
+    //   they are rejected before their fields are bound.
+    template<class T>
+    struct is_aggregate_reflectable: std::conjunction<
+      std::is_class<T>,
+      std::is_aggregate<T>,
+      std::negation<is_trivial<T>>,
+      std::negation<is_member_accessible<T>>,
+      std::negation<is_protocol_compatible<T>>,
+      std::negation<is_specialized<T>>,
+      detail::is_bindable<T>,
+      std::negation<detail::has_array_fields<T>>,
+      detail::are_fields_transparent<T>
+      >{};
+
     template<class T >
     struct is_transparent<T, typename std::enable_if<
 			       is_trivial<T>::value
 			       or is_member_accessible<T>::value
 			       or is_protocol_compatible<T>::value
 			       or is_specialized<T>::value
+			       or is_aggregate_reflectable<T>::value
 			       >::type>: std::true_type {};
   }
   
@@ -142,13 +537,6 @@ namespace mem_comparable_closure {
     //      template<>
     //      struct is_trivial<signed long long int> :std::true_type{};
 
-    template<>
-    struct is_trivial<float> :std::true_type{};
-    template<>
-    struct is_trivial<double> :std::true_type{};
-      
-    template<>
-    struct is_trivial<long double> :std::true_type{};
     template<>
     struct is_trivial<wchar_t> :std::true_type{};
    
@@ -160,13 +548,25 @@ namespace mem_comparable_closure {
 namespace mem_comparable_closure {
   namespace algorithm{
     
+    // returns a pointer to the stable id of a function
+    //   or nullptr if the function has none
+    using function_id_fn_t = const std::uint64_t*(*)(void(*)());
+
     class IteratorStack{
       // initial maximum size
       static constexpr  std::size_t init_max_size() { return 256;};
     public:
-      IteratorStack( ):size(0),max_size(init_max_size()){
-	this->stack_base = reinterpret_cast<char*>(std::aligned_alloc(MAX_SCALAR_ALIGNMENT,init_max_size()));
-	if (!this->stack_base)throw std::bad_alloc();
+      // the storage is allocated on first use
+      IteratorStack( ):stack_base(nullptr),size(0),max_size(0){};
+
+      IteratorStack(const IteratorStack& ) = delete;
+      IteratorStack& operator=(const IteratorStack& ) = delete;
+      IteratorStack(IteratorStack&& other ):
+	stack_base(other.stack_base),size(other.size),max_size(other.max_size),
+	function_id_fn(other.function_id_fn){
+	other.stack_base = nullptr;
+	other.size = 0;
+	other.max_size = 0;
       };
 
       // allocates a new T
@@ -203,7 +603,41 @@ namespace mem_comparable_closure {
 	this->size -= this->calculate_size_increase<T>();
 	return ret;
       }
+
+      // allocates an (uninitialized) array of n T and returns its offset.
+      //   a later allocation can move the stack,
+      //   so the array has to be accessed via get_array_at(offset).
+      template<class T>
+      std::size_t get_new_array(std::size_t n){
+	static_assert( alignof(T)<MAX_SCALAR_ALIGNMENT, "unsupported alignment");
+	static_assert( std::is_trivially_destructible<T>::value, "arrays are never destructed");
+	std::size_t old_size =  this->size;
+	std::size_t new_size =  this->size + this->calculate_size_increase(n*sizeof(T));
+	while (new_size > this->max_size) {
+	  this->reallocate();
+	};
+	this->size = new_size;
+	return old_size;
+      }
+
+      template<class T>
+      T* get_array_at(std::size_t offset){
+	assert(offset <= this->size);
+	return reinterpret_cast<T*>(this->stack_base+offset);
+      }
+
+      // deallocates the last array of n T
+      template<class T>
+      void pop_last_array(std::size_t n){
+	assert(this->size>= this->calculate_size_increase(n*sizeof(T)));
+	this->size -= this->calculate_size_increase(n*sizeof(T));
+      }
       
+      // drops all objects (they are never destructed) and keeps the storage
+      void clear(){
+	this->size = 0;
+      };
+
       ~IteratorStack(){
 	std::free(this->stack_base);
       };
@@ -211,14 +645,18 @@ namespace mem_comparable_closure {
     private:
       template <class T>
       constexpr std::size_t calculate_size_increase() const{
-	return (sizeof(T)/MAX_SCALAR_ALIGNMENT+ (sizeof(T) %MAX_SCALAR_ALIGNMENT==0?0:1))*MAX_SCALAR_ALIGNMENT; 
+	return calculate_size_increase(sizeof(T));
+      }
+
+      static constexpr std::size_t calculate_size_increase(std::size_t bytes){
+	return (bytes/MAX_SCALAR_ALIGNMENT+ (bytes %MAX_SCALAR_ALIGNMENT==0?0:1))*MAX_SCALAR_ALIGNMENT; 
       }
       
       void reallocate() {
-	std::size_t new_max_size = 2*this->max_size;
+	std::size_t new_max_size = this->max_size == 0 ? init_max_size() : 2*this->max_size;
 	char *  new_base = reinterpret_cast<char*>(std::aligned_alloc(MAX_SCALAR_ALIGNMENT,new_max_size));
 	if (!new_base)throw std::bad_alloc();
-	std::memcpy(new_base, this->stack_base, this->max_size );
+	if (this->stack_base) std::memcpy(new_base, this->stack_base, this->max_size );
 	  
 	std::free(this->stack_base);
 	  
@@ -227,6 +665,12 @@ namespace mem_comparable_closure {
 
       }
       
+    public:
+      // if set, function pointers are compared by their stable id instead of their address.
+      //   (see FunctionRegistry)
+      void set_function_id_fn(function_id_fn_t function_id_fn){ this->function_id_fn = function_id_fn;};
+      function_id_fn_t get_function_id_fn()const{return this->function_id_fn;};
+
     public:// for testing
       constexpr static std::size_t get_init_max_size(){return init_max_size(); };
       std::size_t get_size()const{return this->size;};
@@ -236,6 +680,7 @@ namespace mem_comparable_closure {
       char * stack_base;
       std::size_t size;
       std::size_t max_size;
+      function_id_fn_t function_id_fn = nullptr;
     };
   };
 };
@@ -264,11 +709,19 @@ namespace mem_comparable_closure{
     //
     // obj is a pointer to the next object to be compared.
     //     size is sizeof(*obj)
+    //
+    // if identity_skip_fn is set, the info is not a chunk but an identity:
+    //   obj is the address of an immutable object below (size is 0).
+    //   if both objects have the same identity, the comparison continues
+    //   with identity_skip_fn, which skips the object below.
+    //   otherwise continuation_fn descends into it.
+    //   an identity is never hashed.
     struct  MemCompareInfo{
       const void* next_obj;
       MemCompareInfo(*continuation_fn)(IteratorStack&, const void*);
       const void* obj;
       std::size_t size;
+      MemCompareInfo(*identity_skip_fn)(IteratorStack&, const void*) = nullptr;
     };
     
     using mem_compare_continuation_fn_t = decltype(MemCompareInfo::continuation_fn);
@@ -299,6 +752,43 @@ namespace mem_comparable_closure{
 	const void * next_obj;
 	mem_compare_continuation_fn_t  continuation_fn;
       };
+
+      // pops the saved ComparisonIteratorBase and returns to its continuation 
+      inline MemCompareInfo continue_with_saved(IteratorStack& stack,
+						const void* ){
+	auto saved = stack.pop_last<ComparisonIteratorBase>();
+	return MemCompareInfo{
+	  .next_obj = saved.next_obj,
+	    .continuation_fn = saved.continuation_fn,
+	    .obj  = nullptr,
+	    .size =0
+	    };
+      };
+
+      // the chunk of a function pointer:
+      //   its address or its stable id (if the stack has a function_id_fn)
+      template<class F>
+      MemCompareInfo get_function_pointer_mem_compare_info(const F* fn,
+							   const void* next_obj,
+							   mem_compare_continuation_fn_t continuation_fn,
+							   IteratorStack& stack){
+	if (auto function_id_fn = stack.get_function_id_fn()){
+	  const std::uint64_t* id = function_id_fn(reinterpret_cast<void(*)()>(*fn));
+	  if (not id) throw std::invalid_argument("the function has no stable id");
+	  return MemCompareInfo{
+	    .next_obj = next_obj,
+	      .continuation_fn = continuation_fn,
+	      .obj  = static_cast<const void*>(id),
+	      .size = sizeof(std::uint64_t)
+	      };
+	};
+	return MemCompareInfo{
+	  .next_obj = next_obj,
+	    .continuation_fn = continuation_fn,
+	    .obj  = static_cast<const void*>(fn),
+	    .size = sizeof(F)
+	    };
+      };
     }
   }
 
@@ -390,23 +880,318 @@ namespace mem_comparable_closure{
       return detail::get_mem_compare_info_member_tuple<0, T>(stack,
 							     static_cast<const void* >(obj));
     };
+
+    // array specialization (for arrays of non-trivial elements)
+    namespace detail{
+      // N is known at compile time, so only the index of the next element is saved.
+      struct ArrayCompareIterator {
+	const void * next_obj;
+	mem_compare_continuation_fn_t  continuation_fn;
+	std::size_t next_element;
+      };
+
+      // obj points to the first element
+      template<class T, std::size_t N>
+      MemCompareInfo continue_array_mem_compare_info(IteratorStack& stack,
+						     const void* obj){
+	auto& it = stack.get_last<ArrayCompareIterator>();
+	if ( it.next_element == N ){
+	  auto saved = stack.pop_last<ArrayCompareIterator>();
+	  return MemCompareInfo{
+	    .next_obj = saved.next_obj,
+	      .continuation_fn = saved.continuation_fn,
+	      .obj  = nullptr,
+	      .size =0
+	      };
+	};
+	std::size_t this_element = it.next_element;
+	it.next_element = it.next_element+1;
+	return get_mem_compare_info(static_cast<const T*>(obj)+this_element,
+				    obj,
+				    continue_array_mem_compare_info<T, N>,
+				    stack);
+      };
+
+      template<class T, std::size_t N>
+      MemCompareInfo get_array_mem_compare_info(const T* elements,
+						const void* next_obj,
+						mem_compare_continuation_fn_t continuation_fn,
+						IteratorStack& stack){
+	if constexpr (N == 0){
+	  return MemCompareInfo{
+	    .next_obj = next_obj,
+	      .continuation_fn = continuation_fn,
+	      .obj  = nullptr,
+	      .size =0
+	      };
+	} else {
+	  new (stack.get_new<ArrayCompareIterator>( )) ArrayCompareIterator{
+	    .next_obj = next_obj,
+	      .continuation_fn = continuation_fn,
+	      .next_element = 0
+	      };
+	  return continue_array_mem_compare_info<T, N>(stack, static_cast<const void*>(elements));
+	};
+      };
+    }
+
+    template<class T, std::size_t N>
+    typename std::enable_if<concepts::is_specialized<T[N]>::value, MemCompareInfo>::type
+    get_mem_compare_info(const T (*obj)[N],
+			 const void* next_obj,
+			 mem_compare_continuation_fn_t continuation_fn,
+			 IteratorStack& stack){
+      return detail::get_array_mem_compare_info<T, N>(*obj, next_obj, continuation_fn, stack);
+    };
+
+    template<class T, std::size_t N>
+    typename std::enable_if<concepts::is_specialized<std::array<T, N>>::value, MemCompareInfo>::type
+    get_mem_compare_info(const std::array<T, N>* obj,
+			 const void* next_obj,
+			 mem_compare_continuation_fn_t continuation_fn,
+			 IteratorStack& stack){
+      return detail::get_array_mem_compare_info<T, N>(obj->data(), next_obj, continuation_fn, stack);
+    };
+
+    // is_aggregate_reflectable specialization
+    namespace detail{
+      // the fields of a reflected aggregate are compared in segments.
+      //   a segment is either a run of adjacent trivial fields without padding in between
+      //   (compared with a single memcmp) or a single field.
+      template<std::size_t n>
+      struct FieldLayout{
+	// the offsets as a standard layout struct would have them
+	std::size_t offset[n] = {};
+	std::size_t segment_count = 0;
+	std::size_t segment_first_field[n] = {};
+	std::size_t segment_size[n] = {};
+	bool segment_is_run[n] = {};
+      };
+
+      // the layout of n fields with the given sizes and alignments (in this order)
+      template<std::size_t n>
+      constexpr FieldLayout<n> make_segment_layout(const std::size_t (&sizes)[n],
+						   const std::size_t (&alignments)[n],
+						   const bool (&trivial)[n],
+						   bool coalesce){
+	FieldLayout<n> layout{};
+	std::size_t end = 0;
+	for (std::size_t k = 0; k< n; ++k){
+	  layout.offset[k] = (end + alignments[k]-1)/alignments[k]*alignments[k];
+	  end = layout.offset[k] + sizes[k];
+	};
+	for (std::size_t k = 0; k< n; ++k){
+	  const std::size_t last = layout.segment_count-1;
+	  if (coalesce and k > 0 and trivial[k] and layout.segment_is_run[last]
+	      and layout.offset[layout.segment_first_field[last]] + layout.segment_size[last] == layout.offset[k]){
+	    layout.segment_size[last] += sizes[k];
+	  } else {
+	    layout.segment_first_field[layout.segment_count] = k;
+	    layout.segment_size[layout.segment_count] = sizes[k];
+	    layout.segment_is_run[layout.segment_count] = trivial[k];
+	    ++layout.segment_count;
+	  };
+	};
+	return layout;
+      };
+
+      template<class T, bool coalesce, std::size_t ...i>
+      constexpr FieldLayout<sizeof...(i)> make_field_layout(std::index_sequence<i...>){
+	constexpr std::size_t sizes[] = {sizeof(reflection::field_t<i,T>)...};
+	constexpr std::size_t alignments[] = {alignof(reflection::field_t<i,T>)...};
+	constexpr bool trivial[] = {concepts::is_trivial<reflection::field_t<i,T>>::value...};
+	return make_segment_layout(sizes, alignments, trivial, coalesce);
+      };
+
+      // the layout is computed at compile time
+      template<class T, bool coalesce>
+      constexpr FieldLayout<reflection::field_count<T>()> field_layout =
+	make_field_layout<T, coalesce>(std::make_index_sequence<reflection::field_count<T>()>{});
+
+      // the real offsets only differ from the computed ones if a field has an alignas.
+      template<class T, std::size_t ...i>
+      bool is_expected_field_layout(const T& obj, std::index_sequence<i...>){
+	constexpr auto& layout = field_layout<T, true>;
+	auto fields = reflection::get_field_pointers(obj);
+	const char* base = reinterpret_cast<const char*>(&obj);
+	return ((reinterpret_cast<const char*>(std::get<i>(fields)) - base
+		 == static_cast<std::ptrdiff_t>(layout.offset[i])) and ...);
+      };
+
+      template<class T, bool coalesce, std::size_t segment>
+      MemCompareInfo continue_reflected_mem_compare_info(IteratorStack& stack,
+							 const void* vobj){
+	constexpr auto& layout = field_layout<T, coalesce>;
+	if constexpr (segment == layout.segment_count){
+	  return continue_with_saved(stack, vobj);
+	} else {
+	  const T* obj = static_cast<const T*>(vobj);
+	  auto field = std::get<layout.segment_first_field[segment]>(reflection::get_field_pointers(*obj));
+	  MemCompareInfo (*fn)(IteratorStack&, const void* ) = continue_reflected_mem_compare_info<T, coalesce, segment+1>;
+	  if constexpr (layout.segment_is_run[segment]){
+	    return MemCompareInfo{
+	      .next_obj = vobj,
+		.continuation_fn = fn,
+		.obj  = static_cast<const void*>(field),
+		.size = layout.segment_size[segment]
+		};
+	  } else {
+	    return get_mem_compare_info(field, vobj, fn, stack);
+	  };
+	};
+      };
+    }
+    
+    template<class T>
+    typename std::enable_if<concepts::is_aggregate_reflectable<T>::value, MemCompareInfo>::type
+    get_mem_compare_info(const T* obj,
+			 const void* next_obj,
+			 mem_compare_continuation_fn_t continuation_fn,
+			 IteratorStack& stack){
+      // the layout is the same for every T, so it is only checked once
+      static const bool is_expected_layout =
+	detail::is_expected_field_layout(*obj, std::make_index_sequence<reflection::field_count<T>()>{});
+      new (stack.get_new<detail::ComparisonIteratorBase>( )) detail::ComparisonIteratorBase{
+	.next_obj = next_obj,
+	  .continuation_fn = continuation_fn
+	  };
+      if (is_expected_layout){
+	return detail::continue_reflected_mem_compare_info<T, true, 0>(stack,
+								       static_cast<const void* >(obj));
+      };
+      return detail::continue_reflected_mem_compare_info<T, false, 0>(stack,
+								      static_cast<const void* >(obj));
+    };
    
   }
 }
 
+// get_root_mem_compare_info
+namespace mem_comparable_closure{
+  namespace algorithm {
+    // calls the fitting get_mem_compare_info for obj.
+    //   classes with a get_mem_compare_info member can't call the free function unqualified
+    //   and a qualified call only sees the specializations declared before the call.
+    //   the unqualified call here also finds specializations declared
+    //   after this header (e.g. mem_comparable_vector.hpp) via ADL on IteratorStack
+    template<class T>
+    MemCompareInfo dispatch_mem_compare_info(const T* obj,
+					     const void* next_obj,
+					     mem_compare_continuation_fn_t continuation_fn,
+					     IteratorStack& stack){
+      return get_mem_compare_info(obj, next_obj, continuation_fn, stack);
+    };
+    
+    // starts the walk of the object tree below obj.
+    //   a leaf (e.g. a trivial) would return its next_obj directly,
+    //   so we put a level above it. The returned info then always has a next_obj.
+    template<class T>
+    MemCompareInfo get_root_mem_compare_info(const T* obj,
+					     IteratorStack& stack){
+      new (stack.get_new<detail::ComparisonIteratorBase>( )) detail::ComparisonIteratorBase{
+	.next_obj = nullptr,
+	  .continuation_fn = nullptr
+	  };
+      return dispatch_mem_compare_info(obj,
+				  static_cast<const void*>(obj),
+				  detail::continue_with_saved,
+				  stack);
+    };
+  }
+}
+
+// hash basics
+namespace mem_comparable_closure {
+  
+  namespace detail {
+    // FNV-1a 
+    constexpr std::uint64_t hash_offset_basis = 14695981039346656037ull;
+    constexpr std::uint64_t hash_prime = 1099511628211ull;
+    // mixed in, when a level of the object tree has been handled
+    constexpr std::uint64_t hash_level_end = 0x9e3779b97f4a7c15ull;
+    
+    inline std::uint64_t hash_bytes(std::uint64_t hash, const void* data, std::size_t size){
+      auto bytes = static_cast<const unsigned char*>(data);
+      for (std::size_t i = 0; i< size; ++i){
+	hash = (hash ^ bytes[i]) * hash_prime;
+      };
+      return hash;
+    };
+
+    inline std::uint64_t hash_value(std::uint64_t hash, std::uint64_t value){
+      return hash_bytes(hash, &value, sizeof(value));
+    };
+  };
+
+  // combines two hashes. not commutative.
+  inline std::size_t hash_combine(std::size_t seed, std::size_t hash){
+    return static_cast<std::size_t>(detail::hash_value(seed, hash));
+  };
+
+  // see below
+  template<class T>
+  std::size_t structural_hash(const T& obj);
+  template<class T>
+  std::size_t fingerprint_of(const T& obj);
+
+  namespace detail{
+    // true while a constexpr function is evaluated at compile time.
+    //   addresses can't be hashed then, so a constant closure computes its fingerprint on demand.
+    constexpr bool is_constant_evaluated(){
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+      return __builtin_is_constant_evaluated();
+#else
+      return false;
+#endif
+    };
+
+    // the fingerprint of a function pointer (0 at compile time)
+    template<class F>
+    constexpr std::size_t function_pointer_fingerprint(const F& fn){
+      if (is_constant_evaluated()) return 0;
+      return static_cast<std::size_t>(hash_bytes(hash_offset_basis, &fn, sizeof(fn)));
+    };
+  }
+}
+
 // ClosureBase
 // Function
 namespace mem_comparable_closure{
   using  algorithm::mem_compare_continuation_fn_t;
   using  algorithm::IteratorStack;
   using  algorithm::MemCompareInfo;
-  
+
+  template< class current_function_signature, class ...closed_t>
+  class ClosureContainer;
+
+  namespace detail{
+    // the parameter types of ClosureContainer::invoke.
+    //   small trivially copyable values are passed by value (so they can stay in registers),
+    //   everything else by reference. Either way a value is only copied
+    //   into the parameter of the function pointer.
+    template<class T>
+    constexpr bool is_passed_by_value = std::is_trivially_copyable<T>::value
+      and sizeof(T) <= 2*sizeof(void*);
+
+    // for the arguments
+    template<class T>
+    using forward_param_t = typename std::conditional<
+      not std::is_reference<T>::value and is_passed_by_value<T>,
+      T,
+      T&&>::type;
+  }
+
   template<class return_t , class ...Args_t>
   struct ClosureBase{
     virtual return_t operator()(Args_t... )const =0;
     virtual MemCompareInfo get_mem_compare_info(const void* next_obj,
 						mem_compare_continuation_fn_t continuation,
 						IteratorStack& stack)const=0;
+    // identical closures have to have equal fingerprints,
+    //   also across implementations: a closure compared like a ClosureContainer
+    //   has to return the fingerprint of that container (e.g. by forwarding to it).
+    //   a FunctionIndex only compares Functions with equal fingerprints.
+    virtual std::size_t get_fingerprint()const =0;
     virtual ~ClosureBase(){};
   };
   
@@ -414,42 +1199,181 @@ namespace mem_comparable_closure{
   struct concepts::is_protocol_compatible<ClosureBase<T...>>
     : std::true_type{ };
 
-    
+  namespace detail{
+    // the heap object behind a Function.
+    template<class T>
+    struct SharedValue{
+      std::atomic<std::size_t> use_count;
+      T value;
+    };
+
+    // adapts a ClosureBase to the interface of a ClosureContainer
+    template<class return_t , class ...Args_t>
+    struct ClosureBaseAdapter{
+      std::shared_ptr<ClosureBase<return_t, Args_t...>> closure;
+
+      template<class ...U>
+      return_t invoke(U... args)const{
+	return (*this->closure)(std::forward<U>(args)...);
+      };
+
+      MemCompareInfo get_mem_compare_info(const void* next_obj,
+					  mem_compare_continuation_fn_t continuation,
+					  IteratorStack& stack)const{
+	return this->closure->get_mem_compare_info(next_obj, continuation, stack);
+      };
+
+      std::size_t get_fingerprint()const{
+	return this->closure->get_fingerprint();
+      };
+    };
+
+    // the entries of the vtable of a Function holding a T.
+    //   T is a ClosureContainer or a ClosureBaseAdapter
+    template<class T, class return_t, class ...Args_t>
+    struct FunctionOps{
+      using shared_t = SharedValue<T>;
+
+      static return_t invoke(const void* object, forward_param_t<Args_t>... args){
+	return static_cast<const shared_t*>(object)->value.template invoke<forward_param_t<Args_t>...>(
+	    std::forward<forward_param_t<Args_t>>(args)... );
+      };
+
+      static MemCompareInfo get_mem_compare_info(const void* object,
+						 const void* next_obj,
+						 mem_compare_continuation_fn_t continuation,
+						 IteratorStack& stack){
+	return static_cast<const shared_t*>(object)->value.get_mem_compare_info(next_obj, continuation, stack);
+      };
+
+      // closures are immutable, so a clone shares the value
+      static void* clone(void* object){
+	static_cast<shared_t*>(object)->use_count.fetch_add(1, std::memory_order_relaxed);
+	return object;
+      };
+
+      static void destroy(void* object){
+	shared_t* shared = static_cast<shared_t*>(object);
+	if (shared->use_count.fetch_sub(1, std::memory_order_acq_rel) == 1){
+	  delete shared;
+	};
+      };
+    };
+  }
+
+  // Function erases the closed over types.
+  //   instead of a pointer to a virtual base it stores its vtable (invoke, get_mem_compare_info,
+  //   clone and destroy) inline next to the object pointer,
+  //   so a call is a single indirect call into code which knows the complete ClosureContainer.
   template<class return_t, class ... Args_t>
   class Function{
+  private:
+    using invoke_fn_t = return_t(*)(const void*, detail::forward_param_t<Args_t>...);
+    using mem_compare_info_fn_t = MemCompareInfo(*)(const void*,
+						    const void*,
+						    mem_compare_continuation_fn_t,
+						    IteratorStack&);
+    using clone_fn_t = void*(*)(void*);
+    using destroy_fn_t = void(*)(void*);
   public:
     
-    Function( std::shared_ptr<ClosureBase<return_t, Args_t...>> closure ): closure(std::move(closure)){};
-    Function( const Function<return_t, Args_t...>& )=default;
+    Function( std::shared_ptr<ClosureBase<return_t, Args_t...>> closure ){
+      if (closure){
+	this->set_value(detail::ClosureBaseAdapter<return_t, Args_t...>{std::move(closure)});
+      };
+    };
+
+    template<class ...Closed_t>
+    explicit Function(ClosureContainer<FunctionSignature<return_t, Args_t...>, Closed_t...> closure_container){
+      this->set_value(std::move(closure_container));
+    };
+
+    Function( const Function<return_t, Args_t...>& other):
+      object(other.object ? other.clone_fn(other.object) : nullptr),
+      invoke_fn(other.invoke_fn),
+      mem_compare_info_fn(other.mem_compare_info_fn),
+      clone_fn(other.clone_fn),
+      destroy_fn(other.destroy_fn),
+      fingerprint(other.fingerprint){};
     Function<return_t, Args_t...>& operator=( const Function<return_t, Args_t...>& ) = delete;
-    Function( Function<return_t, Args_t...>&& fun) :
-      closure(fun.closure){ fun.closure = nullptr;};
+    Function( Function<return_t, Args_t...>&& other) :
+      object(other.object),
+      invoke_fn(other.invoke_fn),
+      mem_compare_info_fn(other.mem_compare_info_fn),
+      clone_fn(other.clone_fn),
+      destroy_fn(other.destroy_fn),
+      fingerprint(other.fingerprint){ other.reset();};
+
+    ~Function(){
+      if (this->object) this->destroy_fn(this->object);
+    };
     
     Function<return_t, Args_t...> copy() const{
-      return Function<return_t, Args_t...>(this->closure);
+      return Function<return_t, Args_t...>(*this);
     };
     
     Function<return_t, Args_t...>& operator=(Function<return_t, Args_t...>&& other){
-      if ( other.closure ==this->closure) return *this;
-      if(this->closure) delete this->closure;
-      this->closure = other.closure;
-      other.closure = nullptr;
+      if ( &other == this) return *this;
+      if (this->object) this->destroy_fn(this->object);
+      this->object = other.object;
+      this->invoke_fn = other.invoke_fn;
+      this->mem_compare_info_fn = other.mem_compare_info_fn;
+      this->clone_fn = other.clone_fn;
+      this->destroy_fn = other.destroy_fn;
+      this->fingerprint = other.fingerprint;
+      other.reset();
       return *this;
     }
 
     MemCompareInfo get_mem_compare_info(const void* next_obj,
 					mem_compare_continuation_fn_t continuation,
 				        IteratorStack& stack) const {
-      return this->closure->get_mem_compare_info(next_obj, continuation, stack);
+      return this->mem_compare_info_fn(this->object, next_obj, continuation, stack);
+    };
+
+    // the same for all Functions holding the same type (nullptr for an empty Function)
+    //   note: a Function over a ClosureBase has another type than one over the ClosureContainer.
+    using type_id_t = void(*)();
+    type_id_t get_type_id()const{
+      return reinterpret_cast<type_id_t>(this->mem_compare_info_fn);
+    };
+
+    // the fingerprint of the held closure (see ClosureContainer::get_fingerprint)
+    //   0 for an empty Function
+    std::size_t get_fingerprint()const{
+      return this->fingerprint;
     };
     
     return_t operator()(Args_t... args)const{
-      if(!this->closure) throw  std::bad_function_call();
-      return this->closure->operator()(args...);
+      if(!this->object) throw  std::bad_function_call();
+      return this->invoke_fn(this->object, std::forward<Args_t>(args)...);
     };
       
   private:
-    std::shared_ptr<ClosureBase<return_t, Args_t...>> closure;
+    // a moved from Function is empty
+    void reset(){
+      this->object = nullptr;
+      this->mem_compare_info_fn = nullptr;
+      this->fingerprint = 0;
+    };
+
+    template<class T>
+    void set_value(T value){
+      using ops_t = detail::FunctionOps<T, return_t, Args_t...>;
+      this->object = new detail::SharedValue<T>{{1}, std::move(value)};
+      this->invoke_fn = &ops_t::invoke;
+      this->mem_compare_info_fn = &ops_t::get_mem_compare_info;
+      this->clone_fn = &ops_t::clone;
+      this->destroy_fn = &ops_t::destroy;
+      this->fingerprint = static_cast<const detail::SharedValue<T>*>(this->object)->value.get_fingerprint();
+    };
+
+    void* object = nullptr;
+    invoke_fn_t invoke_fn = nullptr;
+    mem_compare_info_fn_t mem_compare_info_fn = nullptr;
+    clone_fn_t clone_fn = nullptr;
+    destroy_fn_t destroy_fn = nullptr;
+    std::size_t fingerprint = 0;
   };
 
   template<class ... T>
@@ -459,20 +1383,143 @@ namespace mem_comparable_closure{
 
 // ClosureContainer
 namespace mem_comparable_closure{
-  template< class current_function_signature, class ...closed_t>
-  class ClosureContainer;
-
   template <class T>
   using remove_cvref = std::remove_cv<typename std::remove_reference<T>::type>;
 
+  // the size report of the bound values of a ClosureContainer (or Closure),
+  //   e.g. static_assert(decltype(closure)::layout.storage_size == decltype(closure)::layout.value_size);
+  struct ClosureLayout{
+    // the sum of the sizes of the bound values
+    std::size_t value_size;
+    // the size of the packed storage, including its padding
+    std::size_t storage_size;
+    // the size of a struct holding the bound values in bind order
+    std::size_t bind_order_size;
+    // the number of chunks the bound values are compared in
+    std::size_t segment_count;
+  };
+
+  namespace detail{
+    // the bound values are stored by decreasing alignment, so there is no padding in between them.
+    //   trivial values go first within one alignment, adjacent trivial values are compared as one chunk.
+    //   otherwise the order of closed_t is kept.
+    //   returns the index in closed_t of each storage slot
+    template<class ...closed_t>
+    constexpr std::array<std::size_t, sizeof...(closed_t)> storage_order(){
+      constexpr std::size_t n = sizeof...(closed_t);
+      constexpr std::size_t alignments[] = {alignof(closed_t)...};
+      constexpr bool trivial[] = {concepts::is_trivial<closed_t>::value...};
+      std::array<std::size_t, n> order{};
+      for (std::size_t k = 0; k< n; ++k){
+	// insertion sort, stable
+	std::size_t j = k;
+	while (j > 0 and (alignments[order[j-1]] < alignments[k]
+			  or (alignments[order[j-1]] == alignments[k] and trivial[k] and not trivial[order[j-1]]))){
+	  order[j] = order[j-1];
+	  --j;
+	};
+	order[j] = k;
+      };
+      return order;
+    };
+
+    template<std::size_t n>
+    constexpr std::array<std::size_t, n> inverse_order(std::array<std::size_t, n> order){
+      std::array<std::size_t, n> inverse{};
+      for (std::size_t k = 0; k< n; ++k){
+	inverse[order[k]] = k;
+      };
+      return inverse;
+    };
+
+    // a tuple with a guaranteed layout: the elements in order, each at the next fitting offset.
+    template<class ...T>
+    struct PackedValues;
+
+    template<class H>
+    struct PackedValues<H>{
+      constexpr explicit PackedValues(H head):head(std::move(head)){};
+      H head;
+    };
+
+    template<class H, class ...T>
+    struct PackedValues<H, T...>{
+      constexpr explicit PackedValues(H head, T... tail):head(std::move(head)), tail(std::move(tail)...){};
+      H head;
+      PackedValues<T...> tail;
+    };
+
+    template<std::size_t i, class V>
+    constexpr decltype(auto) get_packed(V& values){
+      if constexpr (i == 0){
+	return (values.head);
+      } else {
+	return get_packed<i-1>(values.tail);
+      };
+    };
+
+    template<class closed_tuple_t, class sequence_t>
+    struct packed_values_of;
+
+    template<class ...closed_t, std::size_t ...s>
+    struct packed_values_of<std::tuple<closed_t...>, std::index_sequence<s...>>{
+      using type = PackedValues<
+	typename std::tuple_element<storage_order<closed_t...>()[s], std::tuple<closed_t...>>::type...>;
+    };
+
+    // the signature of the function pointer of a container (all closed values unbound)
+    template<class signature_t, class ...closed_t>
+    struct unbound_signature{
+      using type = signature_t;
+    };
+
+    template<class return_t, class ...Args_t, class first_closure_t, class ...closure_t>
+    struct unbound_signature<FunctionSignature<return_t, Args_t...>, first_closure_t, closure_t...>
+      : unbound_signature<FunctionSignature<return_t, first_closure_t, Args_t...>, closure_t...>{};
+
+    // the type a closed over value is stored as.
+    //   a value bound to a const reference parameter is stored by value,
+    //   so move only values (e.g. a std::unique_ptr) can be closed over.
+    template<class T>
+    struct stored{
+      using type = T;
+    };
+
+    template<class T>
+    struct stored<const T&>{
+      using type = T;
+    };
+
+    template<class T>
+    using stored_t = typename stored<T>::type;
+
+    // the container after binding the first argument
+    template<class signature_t, class ...closed_t>
+    struct bind_first;
+
+    template<class return_t, class first_arg_t, class ...Args_t, class ...closed_t>
+    struct bind_first<FunctionSignature<return_t, first_arg_t, Args_t...>, closed_t...>{
+      using bound_arg_type = typename test::check_transparency<stored_t<first_arg_t>, stored_t<first_arg_t>>::type;
+      using type = ClosureContainer<FunctionSignature<return_t, Args_t...>, first_arg_t, closed_t...>;
+    };
+  }
+
   //BaseContainer (wraps only a function pointer)
   // the function has no arguments
   template<class return_t  >
   class ClosureContainer<
     FunctionSignature<return_t>>{
   public:
-    explicit ClosureContainer(return_t(*fn)( ) ):fn(fn){};
-    return_t operator( )( )const {
+    constexpr explicit ClosureContainer(return_t(*fn)( ) ):
+      fn(fn),
+      fingerprint(detail::function_pointer_fingerprint(fn)){};
+    constexpr return_t operator( )( )const {
+      return (*fn)( );
+    }
+
+    template<class ...U>
+    constexpr return_t invoke(U... args )const {
+      static_assert(sizeof...(U) == 0, "wrong number of arguments");
       return (*fn)( );
     }
 
@@ -484,17 +1531,15 @@ namespace mem_comparable_closure{
       new (stack.get_new<ComparisonIteratorBase>()) ComparisonIteratorBase{
 	.next_obj = next_obj,  
 	  .continuation_fn = continuation};
-      MemCompareInfo info{
-	.next_obj = static_cast<const void*>(this),
-	  .continuation_fn = remove_cvref<decltype(*this)>::type::continue_mem_compare_info,
-	  .obj  = static_cast<const void*>(&(this->fn) ),
-	  .size = sizeof(fn)
-	  };
-      return info;
+      return algorithm::detail::get_function_pointer_mem_compare_info(
+	  &(this->fn),
+	  static_cast<const void*>(this),
+	  remove_cvref<decltype(*this)>::type::end_mem_compare_info,
+	  stack);
     }
 
-    static MemCompareInfo continue_mem_compare_info(IteratorStack& stack,
-						    const void* obj){
+    static MemCompareInfo end_mem_compare_info(IteratorStack& stack,
+					       const void* obj){
       using algorithm::detail::ComparisonIteratorBase;
       auto saved = stack.pop_last<ComparisonIteratorBase>();
       MemCompareInfo info{
@@ -506,9 +1551,25 @@ namespace mem_comparable_closure{
       return info;
     };
 
+    // the fingerprint is a rolling hash over the function pointer and the bound values.
+    //   every bind combines the fingerprint of its parent with the fingerprint_of
+    //   the new value, so a shared prefix is hashed once
+    //   and a bound Function is not walked again.
+    //   identical containers have the same fingerprint.
+    //   a container built at compile time has no fingerprint (0) and computes it on demand.
+    std::size_t get_fingerprint()const{
+      if (this->fingerprint != 0) return this->fingerprint;
+      return detail::function_pointer_fingerprint(this->fn);
+    };
+
+    static constexpr ClosureLayout layout{0, 0, 0, 0};
     
   private:
+    template<class, class ...>
+    friend class ClosureContainer;
+
     return_t (*fn)( );
+    std::size_t fingerprint;
   };
   
   //BaseContainer (wraps only a function pointer)
@@ -517,9 +1578,18 @@ namespace mem_comparable_closure{
   class ClosureContainer<
     FunctionSignature<return_t,first_t, Arg_t...>>{
   public:
-    explicit ClosureContainer(return_t(*fn)(first_t, Arg_t... ) ):fn(fn){};
-    return_t operator( )(first_t first, Arg_t...args )const {
-      return (*fn)(first, args... );
+    constexpr explicit ClosureContainer(return_t(*fn)(first_t, Arg_t... ) ):
+      fn(fn),
+      fingerprint(detail::function_pointer_fingerprint(fn)){};
+    constexpr return_t operator( )(first_t first, Arg_t...args )const {
+      return (*fn)(std::forward<first_t>(first), std::forward<Arg_t>(args)... );
+    }
+
+    // invoke is called with the arguments
+    //   U are the parameter types (see detail::forward_param_t)
+    template<class ...U>
+    constexpr return_t invoke(U... args )const {
+      return (*fn)(std::forward<U>(args)... );
     }
   
     MemCompareInfo get_mem_compare_info(const void* next_obj,
@@ -530,18 +1600,16 @@ namespace mem_comparable_closure{
       new (stack.get_new<ComparisonIteratorBase>()) ComparisonIteratorBase{
 	.next_obj = next_obj,  
 	  .continuation_fn = continuation};
-    
-      MemCompareInfo info{
-	.next_obj = static_cast<const void*>(this),
-	  .continuation_fn = remove_cvref<decltype(*this)>::type::continue_mem_compare_info,
-	  .obj  = static_cast<const void*>(&(this->fn) ),
-	  .size = sizeof(this->fn)
-	  };
-      return info;
+
+      return algorithm::detail::get_function_pointer_mem_compare_info(
+	  &(this->fn),
+	  static_cast<const void*>(this),
+	  remove_cvref<decltype(*this)>::type::end_mem_compare_info,
+	  stack);
     }
-   
-    static MemCompareInfo continue_mem_compare_info(IteratorStack& stack,
-						    const void* obj){
+
+    static MemCompareInfo end_mem_compare_info(IteratorStack& stack,
+					       const void* obj){
       using algorithm::detail::ComparisonIteratorBase;
       auto saved = stack.pop_last<ComparisonIteratorBase>();
       MemCompareInfo info{
@@ -554,116 +1622,138 @@ namespace mem_comparable_closure{
     };      
 
     template<class T>
-    decltype(auto) bind(T closed_arg) {
-      using bound_arg = typename test::check_transparency<first_t, first_t>::type; 
-      return ClosureContainer<FunctionSignature<return_t, Arg_t...>,first_t>(*this, static_cast<bound_arg>(closed_arg));  
+    constexpr decltype(auto) bind(T closed_arg)const {
+      using bound_arg = typename test::check_transparency<detail::stored_t<first_t>, detail::stored_t<first_t>>::type; 
+      return ClosureContainer<FunctionSignature<return_t, Arg_t...>,first_t>(*this, static_cast<bound_arg>(std::move(closed_arg)));  
     }
+
+    std::size_t get_fingerprint()const{
+      if (this->fingerprint != 0) return this->fingerprint;
+      return detail::function_pointer_fingerprint(this->fn);
+    };
+
+    static constexpr ClosureLayout layout{0, 0, 0, 0};
+
   private:
+    template<class, class ...>
+    friend class ClosureContainer;
+
     return_t (*fn)(first_t,Arg_t... );
+    std::size_t fingerprint;
   };
 
 
 
   // Closure
-  // no arguments, at least one closed over argument
+  // at least one closed over argument.
+  //   closed_t is first_closure_t, closure_t... (the last bound value first).
+  //   the bound values are stored in a single detail::PackedValues
+  //   ordered by alignment (see detail::storage_order), the function is called in bind order.
   template<
     class return_t,
+    class ...Args_t,
     class first_closure_t,
     class ...closure_t >
   class ClosureContainer<
-    FunctionSignature<return_t>,
+    FunctionSignature<return_t, Args_t...>,
     first_closure_t,
-    closure_t...>: ClosureContainer<
-    FunctionSignature<return_t,first_closure_t>,
     closure_t...>
   {
+  private:
     using parent_t = ClosureContainer<
-      FunctionSignature<return_t,first_closure_t>,
+      FunctionSignature<return_t,first_closure_t, Args_t...>,
       closure_t...>;
-
-  public:
-    ClosureContainer(parent_t closure,
-		     first_closure_t first):
-      parent_t(closure),
-      first(first){}; 
-
-    return_t operator()()const{
-      return ClosureContainer<
-	FunctionSignature<return_t,first_closure_t>,
-	closure_t...>::operator()(this->first );
-	
+    using function_ptr_t = typename detail::unbound_signature<
+      FunctionSignature<return_t, Args_t...>,
+      first_closure_t,
+      closure_t...>::type::function_ptr_type;
+
+    static constexpr std::size_t closed_count = 1+sizeof...(closure_t);
+    static constexpr std::array<std::size_t, closed_count> order =
+      detail::storage_order<detail::stored_t<first_closure_t>, detail::stored_t<closure_t>...>();
+    static constexpr std::array<std::size_t, closed_count> storage_index =
+      detail::inverse_order(order);
+
+    using values_t = typename detail::packed_values_of<
+      std::tuple<detail::stored_t<first_closure_t>, detail::stored_t<closure_t>...>,
+      std::make_index_sequence<closed_count>>::type;
+
+    // the layout of the values in the order of index_of
+    template<std::size_t ...s>
+    static constexpr algorithm::detail::FieldLayout<closed_count> make_layout(
+	const std::array<std::size_t, closed_count>& index_of,
+	bool coalesce,
+	std::index_sequence<s...>){
+      constexpr std::size_t sizes[] = {sizeof(detail::stored_t<first_closure_t>),
+				       sizeof(detail::stored_t<closure_t>)...};
+      constexpr std::size_t alignments[] = {alignof(detail::stored_t<first_closure_t>),
+					    alignof(detail::stored_t<closure_t>)...};
+      constexpr bool trivial[] = {concepts::is_trivial<detail::stored_t<first_closure_t>>::value,
+				  concepts::is_trivial<detail::stored_t<closure_t>>::value...};
+      const std::size_t ordered_sizes[] = {sizes[index_of[s]]...};
+      const std::size_t ordered_alignments[] = {alignments[index_of[s]]...};
+      const bool ordered_trivial[] = {trivial[index_of[s]]...};
+      return algorithm::detail::make_segment_layout(ordered_sizes, ordered_alignments, ordered_trivial, coalesce);
     };
 
-    MemCompareInfo get_mem_compare_info(const void* next_obj,
-					mem_compare_continuation_fn_t continuation,
-				        IteratorStack& stack)const{
-      using algorithm::detail::ComparisonIteratorBase;
-      // saving continuation
-      new (stack.get_new<ComparisonIteratorBase>()) ComparisonIteratorBase{
-	.next_obj = next_obj,  
-	  .continuation_fn = continuation};
-      return algorithm::get_mem_compare_info(&(this->first),
-					     static_cast<const void*>(this),
-					     parent_t::continue_mem_compare_info,
-					     stack);
-    }
-    
-    static MemCompareInfo continue_mem_compare_info(IteratorStack& stack,
-						    const void* obj){
-      using algorithm::detail::ComparisonIteratorBase;
-      auto self = static_cast<ClosureContainer<
-	FunctionSignature<return_t>,
-				first_closure_t,
-				closure_t...>* >(obj);
-      return algorithm::get_mem_compare_info(&(self->first),
-					     obj,
-					     parent_t::continue_mem_compare_info,
-					     stack);;
+    static constexpr std::array<std::size_t, closed_count> reverse_order(){
+      std::array<std::size_t, closed_count> reverse{};
+      for (std::size_t k = 0; k< closed_count; ++k){
+	reverse[k] = closed_count-1-k;
+      };
+      return reverse;
     };
-  private:
-    first_closure_t first;
-  };
 
+    // the compare segments of the values in storage order
+    static constexpr algorithm::detail::FieldLayout<closed_count> segments =
+      make_layout(order, true, std::make_index_sequence<closed_count>{});
+
+    // the offsets of the values in bind order
+    static constexpr algorithm::detail::FieldLayout<closed_count> bind_order_layout =
+      make_layout(reverse_order(), false, std::make_index_sequence<closed_count>{});
+
+    static constexpr std::size_t max_alignment = std::max({alignof(detail::stored_t<first_closure_t>),
+							   alignof(detail::stored_t<closure_t>)...});
 
-  // Closure with at least one argument
-  //    and at least one enclosed value
-  template<
-    class return_t,
-    class first_closure_t,
-    class first_arg_t,
-    class ...Args_t,
-    class ...closure_t >
-  class ClosureContainer<
-    FunctionSignature<return_t, first_arg_t,Args_t...>,
-    first_closure_t,
-    closure_t...>: ClosureContainer<
-    FunctionSignature<return_t,first_closure_t,first_arg_t, Args_t...>,
-    closure_t...>
-  {
-  private:
-    using parent_t = ClosureContainer<
-    FunctionSignature<return_t,first_closure_t,first_arg_t, Args_t...>,
-      closure_t...>;
   public:
-    ClosureContainer(parent_t closure,
-		     first_closure_t first): parent_t(closure),first(first){}; 
+    constexpr ClosureContainer(parent_t closure,
+			       detail::stored_t<first_closure_t> first):
+      ClosureContainer(closure, first, std::make_index_sequence<closed_count>{}){}; 
 
     template<class T>
-    decltype(auto) bind(T closed_arg) {
-      using bound_arg = typename test::check_transparency<first_arg_t, first_arg_t>::type; 
-      return ClosureContainer<
+    constexpr decltype(auto) bind(T closed_arg)const& {
+      using bind_first_t = detail::bind_first<
 	FunctionSignature<return_t, Args_t...>,
-	first_arg_t,
 	first_closure_t,
-	closure_t...>(
-	    *this,
-	    static_cast<bound_arg>(closed_arg)
-	    );  
+	closure_t...>;
+      using bound_arg = typename bind_first_t::bound_arg_type;
+      return typename bind_first_t::type(*this, static_cast<bound_arg>(std::move(closed_arg)));
     }
 
-    return_t operator()(first_arg_t first, Args_t... args)const{
-      return parent_t::operator()(this->first,first,args... );
+    // moves the bound values instead of copying them
+    template<class T>
+    constexpr decltype(auto) bind(T closed_arg)&& {
+      using bind_first_t = detail::bind_first<
+	FunctionSignature<return_t, Args_t...>,
+	first_closure_t,
+	closure_t...>;
+      using bound_arg = typename bind_first_t::bound_arg_type;
+      return typename bind_first_t::type(std::move(*this), static_cast<bound_arg>(std::move(closed_arg)));
+    }
+
+    constexpr return_t operator()(Args_t... args)const{
+      return this->invoke_with_values(std::make_index_sequence<closed_count>{},
+				      std::forward<Args_t>(args)... );
     };
+
+    // invoke is called with the arguments
+    //   U are the parameter types (see detail::forward_param_t)
+    template<class ...U>
+    constexpr return_t invoke(U... args)const{
+      return this->invoke_with_values(std::make_index_sequence<closed_count>{},
+				      std::forward<U>(args)... );
+    };
+
     MemCompareInfo get_mem_compare_info(const void* next_obj,
 					mem_compare_continuation_fn_t continuation,
 					IteratorStack& stack)const{
@@ -672,26 +1762,118 @@ namespace mem_comparable_closure{
       new (stack.get_new<ComparisonIteratorBase>()) ComparisonIteratorBase{
 	.next_obj = next_obj, 
 	  .continuation_fn = continuation};
-      return algorithm::get_mem_compare_info(&(this->first),
-					  static_cast<const void*>(this),
-					  parent_t::continue_mem_compare_info,
-					  stack);;
+      if constexpr (segments.segment_is_run[0]){
+	return continue_mem_compare_info<0>(stack, static_cast<const void*>(this));
+      } else {
+	// descending into the first value is left to the caller's loop (an empty chunk),
+	//   so nested Functions don't grow the call stack.
+	return MemCompareInfo{
+	  .next_obj = static_cast<const void*>(this),
+	    .continuation_fn = continue_mem_compare_info<0>,
+	    .obj  = static_cast<const void*>(this),
+	    .size = 0
+	    };
+      };
     }
-    
+
+    // the segments of the bound values, then the function pointer
+    template<std::size_t segment>
     static MemCompareInfo continue_mem_compare_info(IteratorStack& stack,
-const void* obj){
+						    const void* obj){
       auto self = static_cast<const ClosureContainer<
-    FunctionSignature<return_t, first_arg_t,Args_t...>,
+	FunctionSignature<return_t, Args_t...>,
 				first_closure_t,
 				closure_t...>*>(obj);
-      return algorithm::get_mem_compare_info(&(self->first),
-				  obj,
-				  parent_t::continue_mem_compare_info,
-				  stack);;
+      if constexpr (segment == segments.segment_count){
+	return algorithm::detail::get_function_pointer_mem_compare_info(
+	    &(self->fn),
+	    obj,
+	    algorithm::detail::continue_with_saved,
+	    stack);
+      } else {
+	constexpr std::size_t first_value = segments.segment_first_field[segment];
+	const auto& value = detail::get_packed<first_value>(self->values);
+	if constexpr (segments.segment_is_run[segment]){
+	  assert(reinterpret_cast<const char*>(&value) - reinterpret_cast<const char*>(&(self->values))
+		 == static_cast<std::ptrdiff_t>(segments.offset[first_value]));
+	  return MemCompareInfo{
+	    .next_obj = obj,
+	      .continuation_fn = continue_mem_compare_info<segment+1>,
+	      .obj  = static_cast<const void*>(&value),
+	      .size = segments.segment_size[segment]
+	      };
+	} else {
+	  return algorithm::dispatch_mem_compare_info(&value,
+						      obj,
+						      continue_mem_compare_info<segment+1>,
+						      stack);
+	};
+      };
     };
 
+    std::size_t get_fingerprint()const{
+      if (this->fingerprint != 0) return this->fingerprint;
+      return this->calculate_fingerprint(std::make_index_sequence<closed_count>{});
+    };
+
+    static constexpr ClosureLayout layout{
+      (sizeof(detail::stored_t<first_closure_t>) + ... + sizeof(detail::stored_t<closure_t>)),
+      sizeof(values_t),
+      (bind_order_layout.offset[closed_count-1] + sizeof(detail::stored_t<first_closure_t>) + max_alignment-1)/max_alignment*max_alignment,
+      segments.segment_count};
+
   private:
-    first_closure_t first;
+    template<class, class ...>
+    friend class ClosureContainer;
+
+    template<std::size_t ...s>
+    constexpr ClosureContainer(parent_t& closure,
+			       detail::stored_t<first_closure_t>& first,
+			       std::index_sequence<s...>):
+      fn(closure.fn),
+      fingerprint(detail::is_constant_evaluated() ? 0 :
+		  hash_combine(closure.get_fingerprint(), fingerprint_of(first))),
+      values(take_value<order[s]>(closure, first)...){};
+
+    // the same rolling hash as the binds compute
+    template<std::size_t ...p>
+    std::size_t calculate_fingerprint(std::index_sequence<p...>)const{
+      std::size_t fingerprint = detail::function_pointer_fingerprint(this->fn);
+      ((fingerprint = hash_combine(fingerprint, fingerprint_of(this->template get_value<closed_count-1-p>()))), ...);
+      return fingerprint;
+    };
+
+    // the value at index i of closed_t, moved out of the parent (or first)
+    template<std::size_t i>
+    static constexpr decltype(auto) take_value(parent_t& closure, detail::stored_t<first_closure_t>& first){
+      if constexpr (i == 0){
+	return std::move(first);
+      } else {
+	return std::move(closure.template get_value<i-1>());
+      };
+    };
+
+    // the value at index i of closed_t
+    template<std::size_t i>
+    constexpr decltype(auto) get_value(){
+      return detail::get_packed<storage_index[i]>(this->values);
+    };
+
+    template<std::size_t i>
+    constexpr decltype(auto) get_value()const{
+      return detail::get_packed<storage_index[i]>(this->values);
+    };
+
+    // the values in bind order (the reverse of closed_t) followed by the arguments
+    template<std::size_t ...p, class ...U>
+    constexpr return_t invoke_with_values(std::index_sequence<p...>, U&&... args)const{
+      return (*this->fn)(this->template get_value<closed_count-1-p>()...,
+			 std::forward<U>(args)... );
+    };
+
+    function_ptr_t fn;
+    std::size_t fingerprint;
+    values_t values;
   };
 
   template<class ... T>
@@ -713,7 +1895,8 @@ namespace mem_comparable_closure{
     explicit ClosureHolder(closure_container_t closure_container):closure_container(std::move(closure_container)){};
       
     return_t operator()(T...args )const{
-      return this->closure_container(args... );
+      return this->closure_container.template invoke<detail::forward_param_t<T>...>(
+	  std::forward<T>(args)... );
     };
       
     MemCompareInfo get_mem_compare_info(const void* next_obj,
@@ -722,6 +1905,10 @@ namespace mem_comparable_closure{
       
       return this->closure_container.get_mem_compare_info(next_obj,continuation,stack);
     };
+
+    std::size_t get_fingerprint()const{
+      return this->closure_container.get_fingerprint();
+    };
     
     static MemCompareInfo continue_mem_compare_info(IteratorStack& stack,
 						    const void* obj){
@@ -741,6 +1928,85 @@ namespace mem_comparable_closure{
 
 }
   
+// FunctionView
+namespace mem_comparable_closure{
+
+  namespace detail{
+    // the entries of the vtable of a FunctionView of a T (a ClosureContainer)
+    template<class T, class return_t, class ...Args_t>
+    struct FunctionViewOps{
+      static return_t invoke(const void* object, forward_param_t<Args_t>... args){
+	return static_cast<const T*>(object)->template invoke<forward_param_t<Args_t>...>(
+	    std::forward<forward_param_t<Args_t>>(args)... );
+      };
+
+      static MemCompareInfo get_mem_compare_info(const void* object,
+						 const void* next_obj,
+						 mem_compare_continuation_fn_t continuation,
+						 IteratorStack& stack){
+	return static_cast<const T*>(object)->get_mem_compare_info(next_obj, continuation, stack);
+      };
+
+      static std::size_t get_fingerprint(const void* object){
+	return static_cast<const T*>(object)->get_fingerprint();
+      };
+    };
+  }
+
+  // FunctionView is a non-owning Function: a pointer to a ClosureContainer and its vtable.
+  //   it neither allocates nor counts references, so it can point at a constant closure
+  //   in static storage. the ClosureContainer has to outlive the view.
+  //   views are compared like the ClosureContainers they point at.
+  template<class return_t, class ... Args_t>
+  class FunctionView{
+  private:
+    using invoke_fn_t = return_t(*)(const void*, detail::forward_param_t<Args_t>...);
+    using mem_compare_info_fn_t = MemCompareInfo(*)(const void*,
+						    const void*,
+						    mem_compare_continuation_fn_t,
+						    IteratorStack&);
+    using fingerprint_fn_t = std::size_t(*)(const void*);
+  public:
+    template<class ...Closed_t>
+    constexpr explicit FunctionView(const ClosureContainer<FunctionSignature<return_t, Args_t...>, Closed_t...>& closure_container):
+      object(&closure_container),
+      invoke_fn(&detail::FunctionViewOps<ClosureContainer<FunctionSignature<return_t, Args_t...>, Closed_t...>,
+		return_t, Args_t...>::invoke),
+      mem_compare_info_fn(&detail::FunctionViewOps<ClosureContainer<FunctionSignature<return_t, Args_t...>, Closed_t...>,
+			  return_t, Args_t...>::get_mem_compare_info),
+      fingerprint_fn(&detail::FunctionViewOps<ClosureContainer<FunctionSignature<return_t, Args_t...>, Closed_t...>,
+		     return_t, Args_t...>::get_fingerprint){};
+
+    // a view of a temporary would dangle
+    template<class ...Closed_t>
+    FunctionView(const ClosureContainer<FunctionSignature<return_t, Args_t...>, Closed_t...>&& ) = delete;
+
+    return_t operator()(Args_t... args)const{
+      return this->invoke_fn(this->object, std::forward<Args_t>(args)...);
+    };
+
+    MemCompareInfo get_mem_compare_info(const void* next_obj,
+					mem_compare_continuation_fn_t continuation,
+				        IteratorStack& stack) const {
+      return this->mem_compare_info_fn(this->object, next_obj, continuation, stack);
+    };
+
+    std::size_t get_fingerprint()const{
+      return this->fingerprint_fn(this->object);
+    };
+
+  private:
+    const void* object;
+    invoke_fn_t invoke_fn;
+    mem_compare_info_fn_t mem_compare_info_fn;
+    fingerprint_fn_t fingerprint_fn;
+  };
+
+  template<class ... T>
+  struct concepts::is_protocol_compatible<FunctionView<T...>>
+    : std::true_type{ };
+}
+
 //Closure
 namespace mem_comparable_closure{
     
@@ -761,19 +2027,38 @@ namespace mem_comparable_closure{
     using closure_container_t = ClosureContainer<FunctionSignature<return_t, Args_t...>,  Closed_t...>;
     using closure_holder_t = ClosureHolder<FunctionSignature<return_t, Args_t...>,  Closed_t...>;
     using function_t = Function<return_t,Args_t...>;
+    using function_view_t = FunctionView<return_t,Args_t...>;
   public:
-    explicit Closure(closure_container_t closure_container) : closure_container( std::move(closure_container)){};
+    constexpr explicit Closure(closure_container_t closure_container) : closure_container( std::move(closure_container)){};
       
-    return_t operator()(Args_t... args)const{
+    constexpr return_t operator()(Args_t... args)const{
       
-      return this->closure_container(args...);
+      return this->closure_container.template invoke<detail::forward_param_t<Args_t>...>(
+	  std::forward<Args_t>(args)...);
+    }
+
+
+    function_t as_fun()const&{
+      return function_t(this->closure_container);
+    }
+
+    function_t as_fun()&&{
+      return function_t(std::move(this->closure_container));
+    }
+
+    // a non-owning view, the Closure has to outlive it
+    constexpr function_view_t as_view()const&{
+      return function_view_t(this->closure_container);
     }
 
+    // a view of a temporary would dangle
+    function_view_t as_view()const&& = delete;
 
-    function_t as_fun(){
-      using closure_base_t = ClosureBase<return_t, Args_t...>;
-      return function_t( std::shared_ptr<closure_base_t>(new closure_holder_t(this->closure_container)) );
+    std::size_t get_fingerprint()const{
+      return this->closure_container.get_fingerprint();
     }
+
+    static constexpr ClosureLayout layout = closure_container_t::layout;
   private:
     closure_container_t closure_container ;
   };
@@ -784,23 +2069,53 @@ namespace mem_comparable_closure{
     using closure_container_t = ClosureContainer<FunctionSignature<return_t, first_arg_t,Args_t...>,  Closed_t...>;
     using closure_holder_t = ClosureHolder<FunctionSignature<return_t,first_arg_t, Args_t...>,  Closed_t...>;
     using function_t = Function<return_t,first_arg_t,Args_t...>;
+    using function_view_t = FunctionView<return_t,first_arg_t,Args_t...>;
   public:
-    explicit Closure(closure_container_t closure_container) : closure_container( std::move(closure_container)){};
+    constexpr explicit Closure(closure_container_t closure_container) : closure_container( std::move(closure_container)){};
       
-    return_t operator()(first_arg_t arg1,Args_t... args)const{
+    constexpr return_t operator()(first_arg_t arg1,Args_t... args)const{
       
-      return this->closure_container(arg1,args...);
+      return this->closure_container.template invoke<
+	detail::forward_param_t<first_arg_t>,
+	detail::forward_param_t<Args_t>...>(
+	    std::forward<first_arg_t>(arg1),
+	    std::forward<Args_t>(args)...);
     }
     
     template<class T>
-    decltype(auto) bind(T arg){
-      return typename fitting_closure<decltype(this->closure_container.bind(arg))>::type(this->closure_container.bind(arg));
+    constexpr decltype(auto) bind(T arg)const&{
+      return typename fitting_closure<decltype(this->closure_container.bind(std::move(arg)))>::type(
+	  this->closure_container.bind(std::move(arg)));
+    }
+
+    // moves the bound values instead of copying them
+    template<class T>
+    constexpr decltype(auto) bind(T arg)&&{
+      return typename fitting_closure<decltype(std::move(this->closure_container).bind(std::move(arg)))>::type(
+	  std::move(this->closure_container).bind(std::move(arg)));
     }
     
-    function_t as_fun(){
-      using closure_base_t = ClosureBase<return_t, first_arg_t,Args_t...>;
-      return function_t( std::shared_ptr<closure_base_t>(new closure_holder_t(this->closure_container)) );
+    function_t as_fun()const&{
+      return function_t(this->closure_container);
+    }
+
+    function_t as_fun()&&{
+      return function_t(std::move(this->closure_container));
     }
+
+    // a non-owning view, the Closure has to outlive it
+    constexpr function_view_t as_view()const&{
+      return function_view_t(this->closure_container);
+    }
+
+    // a view of a temporary would dangle
+    function_view_t as_view()const&& = delete;
+
+    std::size_t get_fingerprint()const{
+      return this->closure_container.get_fingerprint();
+    }
+
+    static constexpr ClosureLayout layout = closure_container_t::layout;
   private:
     closure_container_t closure_container ;
   };
@@ -810,7 +2125,7 @@ namespace mem_comparable_closure{
 namespace mem_comparable_closure{
 
   template<class return_t, class ...T>
-  decltype(auto) closure_from_fp(return_t(*fp)(T... ) ){
+  constexpr decltype(auto) closure_from_fp(return_t(*fp)(T... ) ){
     
     using signature_t = FunctionSignature<return_t, T...>;
     return Closure<signature_t>(ClosureContainer<signature_t>(fp));
@@ -820,7 +2135,7 @@ namespace mem_comparable_closure{
   template<class return_t, class ...T>
   struct ClosureMaker {
     template <class M>
-    static Closure<FunctionSignature<return_t,T...>>  make(M m){
+    static constexpr Closure<FunctionSignature<return_t,T...>>  make(M m){
       // this gives horrible error messages.
       return_t (*fp)(T...) = m;
       return Closure<FunctionSignature<return_t, T...>>( ClosureContainer<FunctionSignature<return_t, T...>> (fp));
@@ -844,51 +2159,95 @@ namespace mem_comparable_closure {
     
   };
 
-  template<class Fun1_t, class Fun2_t>
-  bool is_identical(Fun1_t& fun1, Fun2_t& fun2 ){
-    constexpr auto is_null = [](const void* ptr)->bool {return ! ptr;}; 
-      
-    if (! std::is_same<Fun1_t, Fun2_t>::value ) return false;
-    
-    auto stack1 = algorithm::IteratorStack{};
-    auto stack2 = algorithm::IteratorStack{};
-    MemCompareInfo info1 = fun1.get_mem_compare_info(nullptr,nullptr,stack1);
-    MemCompareInfo info2 = fun2.get_mem_compare_info(nullptr,nullptr,stack2);
- 
-    while (true) {
-      if ( is_null( info1.next_obj) or is_null(info2.next_obj) ){
-	// next_obj ( and continuation_fn ) can only be null if
-	//   the highest level of the object tree has been handled and the the algorithm returns the pointer this function has above given it.
-#ifndef NDEBUG
-	if (is_null(info1.next_obj)){
-	  assert(stack1.get_size() == 0);
-	  assert(! info1.continuation_fn);
-	    
-	};
-	if (is_null(info2.next_obj)){
-	  assert(stack2.get_size() == 0);
-	  assert(!info2.continuation_fn);
-	};
-#endif
+  enum class ComparisonState{ identical, different, more_work };
 
-	if ( not ( is_null(info1.next_obj) and is_null(info2.next_obj))) return false;
-	return true;
-      };
-	
-      if (is_null(info1.obj) or is_null(info2.obj) ) {
-	// the obj being null indicates, that a level has been handled and
-	// the next higher level needs to continue.
-	//   TODO theoretically the function which returns this info could themselves call the continuation.
-	// however I believe this way we get a somewhat more sensible stack trace... 
+  // Comparator compares two object trees in steps.
+  //   all traversal state lives in the two IteratorStacks and the current MemCompareInfos,
+  //   so the comparison can be suspended between any two chunks
+  //   and within a chunk.
+  //   both objects have to outlive the Comparator and must not change in between steps.
+  template<class T>
+  class Comparator{
+  public:
+    Comparator(const T& obj1, const T& obj2):
+      Comparator(obj1, obj2, own_stack1, own_stack2){};
+
+    // compares with the given stacks, e.g. to reuse their storage for many comparisons.
+    //   the stacks have to be empty (see IteratorStack::clear).
+    Comparator(const T& obj1, const T& obj2,
+	       algorithm::IteratorStack& stack1, algorithm::IteratorStack& stack2):
+      stack1(stack1),
+      stack2(stack2),
+      info1(algorithm::get_root_mem_compare_info(&obj1,this->stack1)),
+      info2(algorithm::get_root_mem_compare_info(&obj2,this->stack2)){};
+
+    Comparator(const Comparator<T>& ) = delete;
+    Comparator<T>& operator=(const Comparator<T>& ) = delete;
+
+    // compares at most byte_budget bytes.
+    //   handling the end of a level costs no budget.
+    //   a budget of 0 compares one chunk (or the rest of it) as a whole,
+    //   so every step makes progress.
+    //   returns more_work, if the budget was used up before the comparison was decided.
+    ComparisonState step(std::size_t byte_budget){
+      constexpr auto is_null = [](const void* ptr)->bool {return ! ptr;}; 
+      if (this->state != ComparisonState::more_work) return this->state;
+      bool is_chunk_budget = byte_budget == 0;
+      // the loop works on copies, which the continuations can't alias,
+      //   so they stay in registers. they are saved if the budget is used up.
+      MemCompareInfo info1 = this->info1;
+      MemCompareInfo info2 = this->info2;
+      std::size_t offset = this->offset;
+      while (true) {
+	if ( is_null( info1.next_obj) or is_null(info2.next_obj) ){
+	  // next_obj ( and continuation_fn ) can only be null if
+	  //   the highest level of the object tree has been handled and the the algorithm returns the pointer it has been given above.
 #ifndef NDEBUG
-	if (is_null(info1.obj)){
-	  assert(info1.size == 0);
+	  if (is_null(info1.next_obj)){
+	    assert(stack1.get_size() == 0);
+	    assert(! info1.continuation_fn);
+	  };
+	  if (is_null(info2.next_obj)){
+	    assert(stack2.get_size() == 0);
+	    assert(!info2.continuation_fn);
+	  };
+#endif
+	  if ( not ( is_null(info1.next_obj) and is_null(info2.next_obj))) return this->finish(ComparisonState::different);
+	  return this->finish(ComparisonState::identical);
 	};
-	if (is_null(info2.next_obj)){
-	  assert(info2.size == 0);
+	
+	if (info1.identity_skip_fn or info2.identity_skip_fn){
+	  if ( not (info1.identity_skip_fn and info2.identity_skip_fn)) return this->finish(ComparisonState::different);
+	  if (info1.obj == info2.obj){
+	    info1 = info1.identity_skip_fn(stack1, info1.next_obj );
+	    info2 = info2.identity_skip_fn(stack2, info2.next_obj );
+	    continue;
+	  };
+	} else if (is_null(info1.obj) or is_null(info2.obj) ) {
+	  // the obj being null indicates, that a level has been handled and
+	  // the next higher level needs to continue.
+	  assert( not is_null(info1.obj) or info1.size == 0);
+	  assert( not is_null(info2.obj) or info2.size == 0);
+	  if ( not ( is_null(info1.obj) and is_null(info2.obj))) return this->finish(ComparisonState::different);
+	} else {
+	  if (info1.size != info2.size) return this->finish(ComparisonState::different);
+	  const std::size_t remaining = info1.size - offset;
+	  if (remaining > byte_budget){
+	    if (not is_chunk_budget){
+	      // split the chunk
+	      if (not is_identical_range(info1, info2, offset, byte_budget)) return this->finish(ComparisonState::different);
+	      this->info1 = info1;
+	      this->info2 = info2;
+	      this->offset = offset + byte_budget;
+	      return ComparisonState::more_work;
+	    };
+	    is_chunk_budget = false;
+	    byte_budget = remaining;
+	  };
+	  if (not is_identical_range(info1, info2, offset, remaining)) return this->finish(ComparisonState::different);
+	  byte_budget -= remaining;
+	  offset = 0;
 	};
-#endif
-	if ( not ( is_null(info1.obj) and is_null(info2.obj))) return false;
 	assert(  info1.continuation_fn);
 	assert(  info1.next_obj);  
 	info1 = info1.continuation_fn(stack1, info1.next_obj );
@@ -896,25 +2255,145 @@ namespace mem_comparable_closure {
 	assert(  info2.continuation_fn);
 	assert(  info2.next_obj);
 	info2 = info2.continuation_fn(stack2, info2.next_obj );
-      }; 
-      if (! detail::is_identical_object( info1,info2)) return false;
-      assert(  info1.continuation_fn);
-      assert(  info1.next_obj);  
-      info1 = info1.continuation_fn(stack1, info1.next_obj );
-	
-      assert(  info2.continuation_fn);
-      assert(  info2.next_obj);
-      info2 = info2.continuation_fn(stack2, info2.next_obj );
+      };
+    };
 
+    ComparisonState get_state()const{return this->state;};
+  private:
+    static bool is_identical_range(const MemCompareInfo& info1, const MemCompareInfo& info2,
+				   std::size_t offset, std::size_t size){
+      auto obj1 = static_cast<const char*>(info1.obj) + offset;
+      auto obj2 = static_cast<const char*>(info2.obj) + offset;
+      return std::memcmp(obj1, obj2, size) == 0;
+    };
+
+    ComparisonState finish(ComparisonState state){
+      this->state = state;
+      return state;
+    };
+    
+    // only used if no stacks are given
+    algorithm::IteratorStack own_stack1;
+    algorithm::IteratorStack own_stack2;
+    algorithm::IteratorStack& stack1;
+    algorithm::IteratorStack& stack2;
+    MemCompareInfo info1;
+    MemCompareInfo info2;
+    // the number of bytes of the current chunks which are already compared
+    std::size_t offset = 0;
+    ComparisonState state = ComparisonState::more_work;
+  };
+
+  // is_identical works on every transparent type
+  //  (a Function, a ClosureContainer, a vector ...)
+  template<class Fun1_t, class Fun2_t>
+  bool is_identical(const Fun1_t& fun1, const Fun2_t& fun2 ){
+    if constexpr (! std::is_same<Fun1_t, Fun2_t>::value ){
+      return false;
+    } else {
+      Comparator<Fun1_t> comparator(fun1, fun2);
+      return comparator.step(std::numeric_limits<std::size_t>::max()) == ComparisonState::identical;
     };
   }
   template<class Fun1_t, class Fun2_t>
-  bool is_updated(Fun1_t& fun1, Fun2_t& fun2 ){
-    return ! is_identical<Fun1_t, Fun2_t>(fun1, fun2 );
+  bool is_updated(const Fun1_t& fun1, const Fun2_t& fun2 ){
+    return ! is_identical(fun1, fun2 );
   };
     
     
 }; // mem_comparable_closure
+
+// structural hash
+namespace mem_comparable_closure {
+  
+  namespace algorithm {
+    // walks the object tree below obj like is_identical does
+    //   and calls fn(chunk, size) for every chunk.
+    //   the end of a level is passed as fn(nullptr, 0)
+    //   the walk stops early if fn returns false.
+    //   returns false if the walk was stopped.
+    template<class T, class F>
+    bool for_each_chunk(const T& obj, F fn){
+      auto stack = IteratorStack{};
+      return for_each_chunk(obj, stack, std::move(fn));
+    };
+
+    // walks with the given (empty) stack, e.g. one with a function_id_fn
+    template<class T, class F>
+    bool for_each_chunk(const T& obj, IteratorStack& stack, F fn){
+      assert(stack.get_size() == 0);
+      MemCompareInfo info = get_root_mem_compare_info(&obj,stack);
+      while (info.next_obj){
+	assert( info.obj or info.size == 0);
+	// an identity is always descended into
+	if (not info.identity_skip_fn and not fn(info.obj, info.size)) return false;
+	assert(info.continuation_fn);
+	info = info.continuation_fn(stack, info.next_obj);
+      };
+      assert(stack.get_size() == 0);
+      return true;
+    };
+  }
+
+  namespace detail {
+    inline std::uint64_t hash_chunk(std::uint64_t hash, const void* chunk, std::size_t size){
+      if (not chunk) return hash_value(hash, hash_level_end);
+      hash = hash_value(hash, size);
+      return hash_bytes(hash, chunk, size);
+    };
+
+    // hashes every chunk of obj with the given (empty) stack,
+    //   e.g. to reuse its storage for many hashes.
+    //   with a function_id_fn, functions are hashed by their stable id
+    template<class T>
+    std::uint64_t hash_walk(const T& obj, algorithm::IteratorStack& stack){
+      std::uint64_t hash = hash_offset_basis;
+      algorithm::for_each_chunk(obj, stack, [&hash](const void* chunk, std::size_t size){
+	hash = hash_chunk(hash, chunk, size);
+	return true;
+      });
+      return hash;
+    };
+
+    template<class T>
+    std::uint64_t hash_walk(const T& obj, algorithm::function_id_fn_t function_id_fn){
+      auto stack = algorithm::IteratorStack{};
+      stack.set_function_id_fn(function_id_fn);
+      return hash_walk(obj, stack);
+    };
+  }
+  
+  // structural_hash walks the same object tree as is_identical
+  //   and hashes every compared chunk (and its size).
+  //   is_identical(a,b) implies structural_hash(a) == structural_hash(b)
+  //   note: function pointers are part of the hash,
+  //   so the hash is only stable within one process.
+  template<class T>
+  std::size_t structural_hash(const T& obj){
+    return static_cast<std::size_t>(detail::hash_walk(obj, nullptr));
+  };
+
+  namespace concepts{
+    template<class T, class = void>
+    struct has_fingerprint : std::false_type{};
+
+    template<class T>
+    struct has_fingerprint<T, std::void_t<decltype(std::declval<const T&>().get_fingerprint())>>
+      : std::true_type{};
+  }
+
+  // the precomputed fingerprint of a closure (a Function, a Closure, a ClosureContainer)
+  //   and the structural_hash of everything else.
+  //   is_identical(a,b) implies fingerprint_of(a) == fingerprint_of(b)
+  template<class T>
+  std::size_t fingerprint_of(const T& obj){
+    if constexpr (concepts::has_fingerprint<T>::value){
+      return obj.get_fingerprint();
+    } else {
+      return structural_hash(obj);
+    };
+  };
+}; // mem_comparable_closure
   
 
 #endif //MEM_COMPARABLE_CLOSURE_HPP
@@ -0,0 +1,165 @@
+#ifndef MEM_COMPARABLE_DIFF_HPP
+#define MEM_COMPARABLE_DIFF_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// Edit
+namespace mem_comparable_closure{
+
+  enum class EditKind{
+    // new_vec[new_index] has no counterpart in old_vec
+    insert,
+    // old_vec[old_index] has no counterpart in new_vec
+    remove,
+    // old_vec[old_index] is identical to new_vec[new_index] but changed its relative order
+    move,
+    // old_vec[old_index] takes the place of new_vec[new_index] but is updated
+    update
+  };
+
+  struct Edit{
+    static constexpr std::size_t no_index = static_cast<std::size_t>(-1);
+
+    EditKind kind;
+    std::size_t old_index;
+    std::size_t new_index;
+
+    bool operator==(const Edit& other)const{
+      return this->kind == other.kind
+	and this->old_index == other.old_index
+	and this->new_index == other.new_index;
+    };
+  };
+}
+
+// diff
+namespace mem_comparable_closure{
+  namespace detail{
+
+    // the positions (in sequence) of a longest strictly increasing subsequence of sequence
+    inline std::vector<std::size_t> longest_increasing_subsequence(const std::vector<std::size_t>& sequence){
+      // tails[k] is the position of the smallest tail of an increasing subsequence of length k+1
+      std::vector<std::size_t> tails;
+      std::vector<std::size_t> predecessor(sequence.size(), Edit::no_index);
+      for (std::size_t i = 0; i< sequence.size(); ++i){
+	auto it = std::lower_bound(tails.begin(), tails.end(), sequence[i],
+				   [&sequence](std::size_t position, std::size_t value){
+				     return sequence[position] < value;
+				   });
+	if (it != tails.begin()) predecessor[i] = *std::prev(it);
+	if (it == tails.end()){
+	  tails.push_back(i);
+	} else {
+	  *it = i;
+	};
+      };
+      std::vector<std::size_t> result(tails.size());
+      std::size_t position = tails.empty() ? Edit::no_index : tails.back();
+      for (std::size_t k = tails.size(); k > 0; --k){
+	result[k-1] = position;
+	position = predecessor[position];
+      };
+      return result;
+    };
+  }
+
+  // diff returns an edit script which turns old_vec into new_vec.
+  //   elements are keyed by their fingerprint_of and matched if they are identical.
+  //   matched elements keep their relative order if they are part of
+  //   a longest increasing subsequence, all other matched elements are moves.
+  //   between two elements which keep their order the remaining old and new elements
+  //   are paired up in order as updates, the rest are removes and inserts.
+  //   elements which are identical and keep their order are not part of the script.
+  //   the script lists the removes in the order of old_vec
+  //   followed by all other edits in the order of new_vec.
+  //   hashing is linear, is_identical is only run on hash hits.
+  template<class T>
+  std::vector<Edit> diff(const std::vector<T>& old_vec, const std::vector<T>& new_vec){
+    struct Bucket{
+      std::vector<std::size_t> old_indices;
+      // all old_indices before first_unused are matched
+      std::size_t first_unused = 0;
+    };
+
+    std::unordered_map<std::size_t, Bucket> buckets;
+    buckets.reserve(old_vec.size());
+    for (std::size_t i = 0; i< old_vec.size(); ++i){
+      buckets[fingerprint_of(old_vec[i])].old_indices.push_back(i);
+    };
+
+    std::vector<std::size_t> old_match(old_vec.size(), Edit::no_index);
+    std::vector<std::size_t> new_match(new_vec.size(), Edit::no_index);
+    // the old indices of the matched new elements in the order of new_vec
+    std::vector<std::size_t> matched_old_indices;
+    std::vector<std::size_t> matched_new_indices;
+    for (std::size_t j = 0; j< new_vec.size(); ++j){
+      auto bucket = buckets.find(fingerprint_of(new_vec[j]));
+      if (bucket == buckets.end()) continue;
+      auto& old_indices = bucket->second.old_indices;
+      std::size_t& first_unused = bucket->second.first_unused;
+      for (std::size_t k = first_unused; k< old_indices.size(); ++k){
+	std::size_t i = old_indices[k];
+	if (old_match[i] != Edit::no_index) continue;
+	if (not is_identical(old_vec[i], new_vec[j])) continue;
+	old_match[i] = j;
+	new_match[j] = i;
+	matched_old_indices.push_back(i);
+	matched_new_indices.push_back(j);
+	while (first_unused < old_indices.size()
+	       and old_match[old_indices[first_unused]] != Edit::no_index){
+	  ++first_unused;
+	};
+	break;
+      };
+    };
+
+    std::vector<bool> is_stable(new_vec.size(), false);
+    for (std::size_t position : detail::longest_increasing_subsequence(matched_old_indices)){
+      is_stable[matched_new_indices[position]] = true;
+    };
+
+    std::vector<Edit> removes;
+    std::vector<Edit> edits;
+    // pairs up the unmatched elements in [old_begin, old_end) and [new_begin, new_end)
+    auto add_gap = [&](std::size_t old_begin, std::size_t old_end,
+		       std::size_t new_begin, std::size_t new_end){
+      std::size_t i = old_begin;
+      for (std::size_t j = new_begin; j< new_end; ++j){
+	if (new_match[j] != Edit::no_index){
+	  edits.push_back(Edit{EditKind::move, new_match[j], j});
+	  continue;
+	};
+	while (i < old_end and old_match[i] != Edit::no_index) ++i;
+	if (i < old_end){
+	  edits.push_back(Edit{EditKind::update, i, j});
+	  old_match[i] = j;
+	} else {
+	  edits.push_back(Edit{EditKind::insert, Edit::no_index, j});
+	};
+      };
+      for (; i< old_end; ++i){
+	if (old_match[i] == Edit::no_index){
+	  removes.push_back(Edit{EditKind::remove, i, Edit::no_index});
+	};
+      };
+    };
+
+    std::size_t old_begin = 0;
+    std::size_t new_begin = 0;
+    for (std::size_t j = 0; j< new_vec.size(); ++j){
+      if (not is_stable[j]) continue;
+      add_gap(old_begin, new_match[j], new_begin, j);
+      old_begin = new_match[j]+1;
+      new_begin = j+1;
+    };
+    add_gap(old_begin, old_vec.size(), new_begin, new_vec.size());
+
+    removes.insert(removes.end(), edits.begin(), edits.end());
+    return removes;
+  };
+}
+
+#endif //MEM_COMPARABLE_DIFF_HPP
@@ -0,0 +1,94 @@
+#ifndef MEM_COMPARABLE_INDEX_HPP
+#define MEM_COMPARABLE_INDEX_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <unordered_map>
+#include <vector>
+
+// FunctionIndex
+namespace mem_comparable_closure{
+
+  // FunctionIndex is a set of Functions, no two of them identical (see is_identical).
+  //   it answers "is there a Function identical to this one" without a linear scan:
+  //   the Functions are bucketed by their fingerprint and, within a bucket,
+  //   the candidates of the same dynamic type (see Function::get_type_id) are tried first.
+  //   is_identical is only run on fingerprint hits and all comparisons share two IteratorStacks.
+  //   not thread safe, not even find.
+  template<class return_t, class ...Args_t>
+  class FunctionIndex{
+  public:
+    using function_t = Function<return_t, Args_t...>;
+
+    // returns the Function identical to fun or nullptr.
+    //   the pointer is valid until the next insert or erase.
+    const function_t* find(const function_t& fun)const{
+      auto bucket = this->buckets.find(fun.get_fingerprint());
+      if (bucket == this->buckets.end()) return nullptr;
+      auto position = this->find_in_bucket(bucket->second, fun);
+      if (position == bucket->second.end()) return nullptr;
+      return &(position->fun);
+    };
+
+    // adds fun, unless there already is an identical Function.
+    //   returns the Function in the index and whether fun was added.
+    std::pair<const function_t*, bool> insert(function_t fun){
+      auto& bucket = this->buckets[fun.get_fingerprint()];
+      auto position = this->find_in_bucket(bucket, fun);
+      if (position != bucket.end()) return {&(position->fun), false};
+      auto type_id = fun.get_type_id();
+      bucket.push_back(Entry{type_id, std::move(fun)});
+      ++(this->size);
+      return {&(bucket.back().fun), true};
+    };
+
+    // removes the Function identical to fun, returns whether there was one
+    bool erase(const function_t& fun){
+      auto bucket = this->buckets.find(fun.get_fingerprint());
+      if (bucket == this->buckets.end()) return false;
+      auto position = this->find_in_bucket(bucket->second, fun);
+      if (position == bucket->second.end()) return false;
+      bucket->second.erase(position);
+      if (bucket->second.empty()) this->buckets.erase(bucket);
+      --(this->size);
+      return true;
+    };
+
+    std::size_t get_size()const{return this->size;};
+
+  private:
+    struct Entry{
+      typename function_t::type_id_t type_id;
+      function_t fun;
+    };
+    using bucket_t = std::vector<Entry>;
+
+    // a Function of another type is hardly ever identical, so those come last
+    template<class Bucket>
+    auto find_in_bucket(Bucket& bucket, const function_t& fun)const -> decltype(bucket.begin()){
+      const auto type_id = fun.get_type_id();
+      for (auto it = bucket.begin(); it != bucket.end(); ++it){
+	if (it->type_id == type_id and this->is_identical(it->fun, fun)) return it;
+      };
+      for (auto it = bucket.begin(); it != bucket.end(); ++it){
+	if (it->type_id != type_id and this->is_identical(it->fun, fun)) return it;
+      };
+      return bucket.end();
+    };
+
+    // empty Functions have nothing to compare, they are identical to each other only
+    bool is_identical(const function_t& fun1, const function_t& fun2)const{
+      if (not fun1.get_type_id() or not fun2.get_type_id()) return fun1.get_type_id() == fun2.get_type_id();
+      this->stack1.clear();
+      this->stack2.clear();
+      Comparator<function_t> comparator(fun1, fun2, this->stack1, this->stack2);
+      return comparator.step(std::numeric_limits<std::size_t>::max()) == ComparisonState::identical;
+    };
+
+    std::unordered_map<std::size_t, bucket_t> buckets;
+    std::size_t size = 0;
+    mutable algorithm::IteratorStack stack1;
+    mutable algorithm::IteratorStack stack2;
+  };
+}
+
+#endif //MEM_COMPARABLE_INDEX_HPP
@@ -0,0 +1,148 @@
+#ifndef MEM_COMPARABLE_MEMO_HPP
+#define MEM_COMPARABLE_MEMO_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <list>
+#include <unordered_map>
+
+// MemoCache
+namespace mem_comparable_closure{
+
+  // MemoCache is a bounded least-recently-used cache.
+  //   it maps a Function and the arguments it was called with to the result of the call.
+  //   an entry is found if a structurally identical Function (see is_identical)
+  //   is called with identical arguments. The arguments therefore need to be transparent.
+  //   lookup is done via the fingerprint of the Function and the structural_hash of the arguments,
+  //   is_identical is only run on a hash hit.
+  template<class return_t, class ...Args_t>
+  class MemoCache{
+  private:
+    using function_t = Function<return_t, Args_t...>;
+    using arguments_t = std::tuple<typename remove_cvref<Args_t>::type...>;
+
+    struct Entry{
+      std::size_t hash;
+      function_t fun;
+      arguments_t arguments;
+      return_t result;
+    };
+    using entry_iterator_t = typename std::list<Entry>::iterator;
+  public:
+    explicit MemoCache(std::size_t capacity):capacity(capacity){};
+    MemoCache(const MemoCache<return_t, Args_t...>& ) = delete;
+    MemoCache<return_t, Args_t...>& operator=(const MemoCache<return_t, Args_t...>& ) = delete;
+
+    // returns the cached result of fun(args...) or calls fun and caches the result.
+    return_t operator()(const function_t& fun, Args_t... args){
+      std::size_t hash = this->calculate_hash(fun, args...);
+      auto range = this->index.equal_range(hash);
+      for (auto it = range.first; it != range.second; ++it){
+	entry_iterator_t entry = it->second;
+	if (this->is_identical_entry(*entry, fun, args...)){
+	  ++this->hits;
+	  // mark as most recently used
+	  this->entries.splice(this->entries.begin(), this->entries, entry);
+	  return entry->result;
+	};
+      };
+      ++this->misses;
+      return_t result = fun(args...);
+      if (this->capacity == 0) return result;
+      this->entries.push_front(Entry{
+	  hash,
+	  fun,
+	  arguments_t(args...),
+	  result});
+      this->index.emplace(hash, this->entries.begin());
+      while (this->entries.size() > this->capacity){
+	this->evict_last();
+      };
+      return result;
+    };
+
+    void clear(){
+      this->index.clear();
+      this->entries.clear();
+    };
+
+    void reset_statistics(){
+      this->hits = 0;
+      this->misses = 0;
+      this->evictions = 0;
+    };
+
+    std::size_t get_hits()const{return this->hits;};
+    std::size_t get_misses()const{return this->misses;};
+    std::size_t get_evictions()const{return this->evictions;};
+    std::size_t get_size()const{return this->entries.size();};
+    std::size_t get_capacity()const{return this->capacity;};
+  private:
+    static std::size_t calculate_hash(const function_t& fun, const Args_t&... args){
+      std::size_t hash = fun.get_fingerprint();
+      // a fold over the comma operator to keep the order of the arguments
+      ((hash = hash_combine(hash, structural_hash(args))), ...);
+      return hash;
+    };
+
+    bool is_identical_entry(const Entry& entry, const function_t& fun, const Args_t&... args)const{
+      return is_identical(entry.fun, fun)
+	and is_identical_arguments(entry.arguments,
+				   std::index_sequence_for<Args_t...>{},
+				   args...);
+    };
+
+    template<std::size_t ...i>
+    static bool is_identical_arguments(const arguments_t& arguments,
+				       std::index_sequence<i...>,
+				       const Args_t&... args){
+      return (is_identical(std::get<i>(arguments), args) and ...);
+    };
+
+    void evict_last(){
+      assert(not this->entries.empty());
+      entry_iterator_t last = std::prev(this->entries.end());
+      auto range = this->index.equal_range(last->hash);
+      for (auto it = range.first; it != range.second; ++it){
+	if (it->second == last){
+	  this->index.erase(it);
+	  break;
+	};
+      };
+      this->entries.erase(last);
+      ++this->evictions;
+    };
+
+    std::size_t capacity;
+    std::list<Entry> entries;
+    std::unordered_multimap<std::size_t, entry_iterator_t> index;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+  };
+
+  // Memoized is a Function that looks up its results in a MemoCache
+  //   the cache has to outlive the Memoized.
+  template<class return_t, class ...Args_t>
+  class Memoized{
+  private:
+    using function_t = Function<return_t, Args_t...>;
+    using cache_t = MemoCache<return_t, Args_t...>;
+  public:
+    Memoized(cache_t& cache, function_t fun):cache(&cache), fun(std::move(fun)){};
+
+    return_t operator()(Args_t... args)const{
+      return (*this->cache)(this->fun, args...);
+    };
+  private:
+    cache_t* cache;
+    function_t fun;
+  };
+
+  template<class return_t, class ...Args_t>
+  Memoized<return_t, Args_t...> memoize(Function<return_t, Args_t...> fun,
+					MemoCache<return_t, Args_t...>& cache){
+    return Memoized<return_t, Args_t...>(cache, std::move(fun));
+  };
+}
+
+#endif //MEM_COMPARABLE_MEMO_HPP
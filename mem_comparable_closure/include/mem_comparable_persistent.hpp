@@ -0,0 +1,457 @@
+#ifndef MEM_COMPARABLE_PERSISTENT_HPP
+#define MEM_COMPARABLE_PERSISTENT_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// FunctionRegistry
+namespace mem_comparable_closure{
+
+  // function pointers differ between two runs (ASLR),
+  //   so a fingerprint that should survive the process uses stable ids instead.
+  //   the id of a function is the hash of the schema, the name it is registered with
+  //   and its version. bump the version when the function changes its results,
+  //   so the entries of the old version are no longer found.
+  class FunctionRegistry{
+  private:
+    using erased_fn_t = void(*)();
+  public:
+    // changes when the chunks of a stable walk are hashed differently,
+    //   so entries of another schema are not found
+    static constexpr std::uint64_t schema = 2;
+
+    static FunctionRegistry& instance(){
+      static FunctionRegistry registry;
+      return registry;
+    };
+
+    // returns the id. throws std::invalid_argument,
+    //   if fn is already registered under another name or version or the id is taken.
+    template<class return_t, class ...Args_t>
+    std::uint64_t add(return_t(*fn)(Args_t...), std::string_view name, std::uint64_t version = 0){
+      std::uint64_t id = detail::hash_value(detail::hash_offset_basis, schema);
+      id = detail::hash_bytes(id, name.data(), name.size());
+      id = detail::hash_value(id, version);
+      const erased_fn_t erased_fn = reinterpret_cast<erased_fn_t>(fn);
+      std::unique_lock<std::shared_mutex> lock(this->mutex);
+      auto by_id = this->functions_by_id.find(id);
+      if (by_id != this->functions_by_id.end() and by_id->second != erased_fn){
+	throw std::invalid_argument("the stable id is already taken by another function");
+      };
+      auto by_fn = this->ids.find(erased_fn);
+      if (by_fn != this->ids.end() and by_fn->second != id){
+	throw std::invalid_argument("the function is already registered under another name or version");
+      };
+      this->ids.emplace(erased_fn, id);
+      this->functions_by_id.emplace(id, erased_fn);
+      return id;
+    };
+
+    // the address of the id stays valid (the nodes of an unordered_map don't move)
+    const std::uint64_t* find(erased_fn_t fn)const{
+      std::shared_lock<std::shared_mutex> lock(this->mutex);
+      auto it = this->ids.find(fn);
+      if (it == this->ids.end()) return nullptr;
+      return &(it->second);
+    };
+
+    static const std::uint64_t* find_stable_id(erased_fn_t fn){
+      return instance().find(fn);
+    };
+  private:
+    FunctionRegistry() = default;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<erased_fn_t, std::uint64_t> ids;
+    std::unordered_map<std::uint64_t, erased_fn_t> functions_by_id;
+  };
+
+  template<class return_t, class ...Args_t>
+  std::uint64_t register_function(return_t(*fn)(Args_t...), std::string_view name, std::uint64_t version = 0){
+    return FunctionRegistry::instance().add(fn, name, version);
+  };
+
+  // a structural_hash which is stable across runs (of the same build).
+  //   every function below obj has to be registered,
+  //   otherwise std::invalid_argument is thrown.
+  template<class T>
+  std::uint64_t stable_fingerprint(const T& obj){
+    return detail::hash_walk(obj, FunctionRegistry::find_stable_id);
+  };
+
+  // the key of a PersistentCache entry.
+  //   the verification is a second hash of the same chunks, independent of the fingerprint.
+  //   it is stored with the entry and checked on load,
+  //   so two keys whose fingerprints collide don't share an entry.
+  struct CacheKey{
+    std::uint64_t fingerprint;
+    std::uint64_t verification;
+  };
+
+  namespace detail{
+    // a multiply xorshift hash. unlike FNV-1a it adds the bytes
+    //   and folds the high bits back, so FNV-1a collisions don't carry over.
+    constexpr std::uint64_t verification_seed = 0x2545f4914f6cdd1dull;
+    constexpr std::uint64_t verification_prime = 0xff51afd7ed558ccdull;
+
+    inline std::uint64_t verification_hash_bytes(std::uint64_t hash, const void* data, std::size_t size){
+      auto bytes = static_cast<const unsigned char*>(data);
+      for (std::size_t i = 0; i< size; ++i){
+	hash = (hash + bytes[i] + 1) * verification_prime;
+	hash ^= hash >> 29;
+      };
+      return hash;
+    };
+
+    inline std::uint64_t verification_hash_value(std::uint64_t hash, std::uint64_t value){
+      return verification_hash_bytes(hash, &value, sizeof(value));
+    };
+
+    inline std::uint64_t verification_hash_chunk(std::uint64_t hash, const void* chunk, std::size_t size){
+      if (not chunk) return verification_hash_value(hash, hash_level_end);
+      hash = verification_hash_value(hash, size);
+      return verification_hash_bytes(hash, chunk, size);
+    };
+
+    // not commutative, like hash_combine
+    inline CacheKey combine_cache_keys(const CacheKey& seed, const CacheKey& key){
+      return CacheKey{
+	.fingerprint = hash_value(seed.fingerprint, key.fingerprint),
+	  .verification = verification_hash_value(seed.verification, key.verification)};
+    };
+  }
+
+  // the stable_fingerprint and the verification of obj, in one walk
+  template<class T>
+  CacheKey stable_key(const T& obj){
+    auto stack = algorithm::IteratorStack{};
+    stack.set_function_id_fn(FunctionRegistry::find_stable_id);
+    CacheKey key{.fingerprint = detail::hash_offset_basis, .verification = detail::verification_seed};
+    algorithm::for_each_chunk(obj, stack, [&key](const void* chunk, std::size_t size){
+      key.fingerprint = detail::hash_chunk(key.fingerprint, chunk, size);
+      key.verification = detail::verification_hash_chunk(key.verification, chunk, size);
+      return true;
+    });
+    return key;
+  };
+}
+
+// serialization
+namespace mem_comparable_closure{
+
+  // Serializer<T> turns a T into bytes and back.
+  //   specialized for trivial types (no padding and no pointers, see concepts::is_trivial),
+  //   strings and vectors of trivial types.
+  //   a pointer would not be valid in the next run.
+  template<class T, class enable = void>
+  struct Serializer;
+
+  namespace detail{
+    template<class T>
+    constexpr bool is_serializable_as_bytes = concepts::is_trivial<T>::value
+      and std::is_trivially_copyable<T>::value;
+  }
+
+  template<class T>
+  struct Serializer<T, typename std::enable_if<detail::is_serializable_as_bytes<T>>::type>{
+    static std::string serialize(const T& value){
+      return std::string(reinterpret_cast<const char*>(&value), sizeof(T));
+    };
+
+    static std::optional<T> deserialize(std::string_view bytes){
+      if (bytes.size() != sizeof(T)) return std::nullopt;
+      T value;
+      std::memcpy(&value, bytes.data(), sizeof(T));
+      return value;
+    };
+  };
+
+  template<class CharT, class Traits, class Alloc>
+  struct Serializer<std::basic_string<CharT, Traits, Alloc>>{
+    static std::string serialize(const std::basic_string<CharT, Traits, Alloc>& value){
+      return std::string(reinterpret_cast<const char*>(value.data()), value.size()*sizeof(CharT));
+    };
+
+    static std::optional<std::basic_string<CharT, Traits, Alloc>> deserialize(std::string_view bytes){
+      if (bytes.size()%sizeof(CharT) != 0) return std::nullopt;
+      std::basic_string<CharT, Traits, Alloc> value(bytes.size()/sizeof(CharT), CharT());
+      std::memcpy(value.data(), bytes.data(), bytes.size());
+      return value;
+    };
+  };
+
+  template<class T, class Alloc>
+  struct Serializer<std::vector<T, Alloc>, typename std::enable_if<detail::is_serializable_as_bytes<T>
+								   and not std::is_same<T, bool>::value>::type>{
+    static std::string serialize(const std::vector<T, Alloc>& value){
+      return std::string(reinterpret_cast<const char*>(value.data()), value.size()*sizeof(T));
+    };
+
+    static std::optional<std::vector<T, Alloc>> deserialize(std::string_view bytes){
+      if (bytes.size()%sizeof(T) != 0) return std::nullopt;
+      std::vector<T, Alloc> value(bytes.size()/sizeof(T));
+      if (not bytes.empty()) std::memcpy(value.data(), bytes.data(), bytes.size());
+      return value;
+    };
+  };
+}
+
+// PersistentCache
+namespace mem_comparable_closure{
+
+  // PersistentCache maps CacheKeys to bytes in a memory mapped file.
+  //   the file is a header, a fixed open addressing table of slots
+  //   and an append only data region, which grows by remapping.
+  //   the data of an entry is written before its slot,
+  //   a slot is only marked used once it is complete.
+  //   the number of slots is fixed when the file is created,
+  //   insert returns false once the table is 3/4 full.
+  //   a cache holds an exclusive lock (flock) on its file,
+  //   opening a file which another cache holds fails instead of waiting.
+  class PersistentCache{
+  private:
+    static constexpr char magic[8] = {'M','C','C','C','A','C','H','E'};
+    static constexpr std::uint64_t version = 2;
+    static constexpr std::size_t initial_data_size = 1 << 16;
+
+    struct FileHeader{
+      char magic[8];
+      std::uint64_t version;
+      std::uint64_t slot_count;
+      std::uint64_t entry_count;
+      // the end of the used data region, relative to the beginning of the file
+      std::uint64_t data_end;
+    };
+
+    struct Slot{
+      std::uint64_t fingerprint;
+      std::uint64_t verification;
+      std::uint64_t offset;
+      std::uint64_t size;
+      std::uint64_t is_used;
+    };
+  public:
+    // opens or creates the cache file at path.
+    //   slot_count is only used if the file is created.
+    //   throws std::system_error if the file can't be opened, locked or mapped
+    //   (EWOULDBLOCK if another cache holds it)
+    //   and std::runtime_error if it is not a cache file.
+    explicit PersistentCache(const std::string& path, std::size_t slot_count = 4096){
+      this->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (this->fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+      // before the size is read, a file is only created once
+      if (::flock(this->fd, LOCK_EX | LOCK_NB) != 0){
+	const int error = errno;
+	this->close_file();
+	throw std::system_error(error, std::generic_category(), "flock");
+      };
+      struct stat file_stat;
+      if (::fstat(this->fd, &file_stat) != 0){
+	this->close_file();
+	throw std::system_error(errno, std::generic_category(), "fstat");
+      };
+      if (file_stat.st_size == 0){
+	assert(slot_count > 0);
+	const std::size_t data_begin = sizeof(FileHeader) + slot_count*sizeof(Slot);
+	this->resize(data_begin + initial_data_size);
+	FileHeader* header = this->get_header();
+	std::memcpy(header->magic, magic, sizeof(magic));
+	header->version = version;
+	header->slot_count = slot_count;
+	header->entry_count = 0;
+	header->data_end = data_begin;
+      } else {
+	this->map(static_cast<std::size_t>(file_stat.st_size));
+	if (not this->is_valid_header()){
+	  this->close_file();
+	  throw std::runtime_error("not a cache file: "+path);
+	};
+      };
+    };
+
+    PersistentCache(const PersistentCache& ) = delete;
+    PersistentCache& operator=(const PersistentCache& ) = delete;
+
+    ~PersistentCache(){
+      this->close_file();
+    };
+
+    std::optional<std::string> find(const CacheKey& key)const{
+      std::lock_guard<std::mutex> lock(this->mutex);
+      const Slot* slot = this->find_slot(key);
+      if (not slot or not slot->is_used) return std::nullopt;
+      // a corrupt slot is a miss
+      if (not this->is_valid_slot(*slot)) return std::nullopt;
+      return std::string(this->mapping + slot->offset, slot->size);
+    };
+
+    // returns false if the key is already present or the table is full
+    bool insert(const CacheKey& key, std::string_view bytes){
+      std::lock_guard<std::mutex> lock(this->mutex);
+      FileHeader* header = this->get_header();
+      if ((header->entry_count+1)*4 > header->slot_count*3) return false;
+      Slot* slot = this->find_slot(key);
+      if (not slot or slot->is_used) return false;
+      // the slot moves with the mapping
+      const std::size_t slot_index = static_cast<std::size_t>(slot - this->get_slots());
+      const std::uint64_t offset = header->data_end;
+      if (offset + bytes.size() > this->mapped_size){
+	this->resize(std::max<std::size_t>(2*this->mapped_size, offset + bytes.size()));
+	header = this->get_header();
+      };
+      if (not bytes.empty()) std::memcpy(this->mapping + offset, bytes.data(), bytes.size());
+      header->data_end = offset + bytes.size();
+      slot = this->get_slots() + slot_index;
+      slot->fingerprint = key.fingerprint;
+      slot->verification = key.verification;
+      slot->offset = offset;
+      slot->size = bytes.size();
+      slot->is_used = 1;
+      ++header->entry_count;
+      return true;
+    };
+
+    template<class T>
+    std::optional<T> load(const CacheKey& key)const{
+      auto bytes = this->find(key);
+      if (not bytes) return std::nullopt;
+      return Serializer<T>::deserialize(*bytes);
+    };
+
+    template<class T>
+    bool store(const CacheKey& key, const T& value){
+      return this->insert(key, Serializer<T>::serialize(value));
+    };
+
+    // writes the mapping back to the file
+    void flush(){
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (::msync(this->mapping, this->mapped_size, MS_SYNC) != 0){
+	throw std::system_error(errno, std::generic_category(), "msync");
+      };
+    };
+
+    std::size_t get_size()const{
+      std::lock_guard<std::mutex> lock(this->mutex);
+      return this->get_header()->entry_count;
+    };
+
+    std::size_t get_slot_count()const{
+      std::lock_guard<std::mutex> lock(this->mutex);
+      return this->get_header()->slot_count;
+    };
+  private:
+    FileHeader* get_header()const{
+      return reinterpret_cast<FileHeader*>(this->mapping);
+    };
+
+    Slot* get_slots()const{
+      return reinterpret_cast<Slot*>(this->mapping + sizeof(FileHeader));
+    };
+
+    // the header of a file which was not created by this cache has to be checked
+    //   before the slots are accessed.
+    bool is_valid_header()const{
+      if (this->mapped_size < sizeof(FileHeader)) return false;
+      const FileHeader* header = this->get_header();
+      if (std::memcmp(header->magic, magic, sizeof(magic)) != 0
+	  or header->version != version
+	  or header->slot_count == 0
+	  // written like this, the size of the slots can't overflow
+	  or header->slot_count > (this->mapped_size - sizeof(FileHeader))/sizeof(Slot)
+	  or header->entry_count > header->slot_count){
+	return false;
+      };
+      const std::uint64_t data_begin = sizeof(FileHeader) + header->slot_count*sizeof(Slot);
+      return header->data_end >= data_begin and header->data_end <= this->mapped_size;
+    };
+
+    // the bytes of a used slot lie in the data region
+    bool is_valid_slot(const Slot& slot)const{
+      const FileHeader* header = this->get_header();
+      const std::uint64_t data_begin = sizeof(FileHeader) + header->slot_count*sizeof(Slot);
+      return header->data_end <= this->mapped_size
+	and slot.offset >= data_begin
+	and slot.offset <= header->data_end
+	and slot.size <= header->data_end - slot.offset;
+    };
+
+    // the slot of key or the empty slot where it would be inserted.
+    //   a slot with the same fingerprint, but another verification belongs to another key.
+    //   nullptr if neither is found after probing every slot once.
+    Slot* find_slot(const CacheKey& key)const{
+      const std::uint64_t slot_count = this->get_header()->slot_count;
+      Slot* slots = this->get_slots();
+      std::uint64_t index = key.fingerprint % slot_count;
+      for (std::uint64_t probe = 0; probe < slot_count; ++probe){
+	if (not slots[index].is_used) return slots+index;
+	if (slots[index].fingerprint == key.fingerprint
+	    and slots[index].verification == key.verification) return slots+index;
+	index = (index+1) % slot_count;
+      };
+      return nullptr;
+    };
+
+    void map(std::size_t size){
+      void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+      if (mapping == MAP_FAILED){
+	this->close_file();
+	throw std::system_error(errno, std::generic_category(), "mmap");
+      };
+      this->mapping = static_cast<char*>(mapping);
+      this->mapped_size = size;
+    };
+
+    void resize(std::size_t size){
+      if (this->mapping) ::munmap(this->mapping, this->mapped_size);
+      this->mapping = nullptr;
+      if (::ftruncate(this->fd, static_cast<off_t>(size)) != 0){
+	this->close_file();
+	throw std::system_error(errno, std::generic_category(), "ftruncate");
+      };
+      this->map(size);
+    };
+
+    void close_file(){
+      if (this->mapping) ::munmap(this->mapping, this->mapped_size);
+      this->mapping = nullptr;
+      if (this->fd >= 0) ::close(this->fd);
+      this->fd = -1;
+    };
+
+    mutable std::mutex mutex;
+    int fd = -1;
+    char* mapping = nullptr;
+    std::size_t mapped_size = 0;
+  };
+
+  // calls fun(args...) or loads the result of an earlier call (maybe from an earlier run).
+  //   the key is the stable_key of fun and args
+  template<class return_t, class ...Args_t>
+  return_t call_cached(PersistentCache& cache,
+		       const Function<return_t, Args_t...>& fun,
+		       Args_t... args){
+    CacheKey key = stable_key(fun);
+    // a fold over the comma operator to keep the order of the arguments
+    ((key = detail::combine_cache_keys(key, stable_key(args))), ...);
+    if (auto result = cache.load<return_t>(key)) return *std::move(result);
+    return_t result = fun(args...);
+    cache.store(key, result);
+    return result;
+  };
+}
+
+#endif //MEM_COMPARABLE_PERSISTENT_HPP
@@ -0,0 +1,111 @@
+#ifndef MEM_COMPARABLE_POINTER_HPP
+#define MEM_COMPARABLE_POINTER_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <memory>
+
+namespace mem_comparable_closure{
+  // only pointers to const are compared by their pointee,
+  //   the pointee of a pointer to non-const could change without the pointer changing.
+  template<class T>
+  struct concepts::is_specialized<std::shared_ptr<const T>> : concepts::is_transparent<T>{};
+
+  template<class T, class Deleter>
+  struct concepts::is_specialized<std::unique_ptr<const T, Deleter>> : concepts::is_transparent<T>{};
+
+  // a smart pointer is compared by whether it is null
+  //   followed by an identity (the address of the pointee) and the pointee.
+  //   pointers to the same object are identical without comparing the pointee,
+  //   (see MemCompareInfo::identity_skip_fn)
+  //   pointers to different but equal objects are still identical.
+  struct PointerCompareIterator{
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    std::size_t is_engaged;
+  };
+
+  namespace algorithm {
+    namespace{
+      template<class P>
+      MemCompareInfo continue_pointee_mem_compare_info(IteratorStack& stack,
+						       const void* obj){
+	auto self = static_cast<const P*>(obj);
+	auto saved = stack.pop_last<PointerCompareIterator>();
+	new (stack.get_new<detail::ComparisonIteratorBase>( )) detail::ComparisonIteratorBase{
+	  .next_obj = saved.next_obj,
+	    .continuation_fn = saved.continuation_fn
+	    };
+	return get_mem_compare_info(self->get(),
+				    obj,
+				    detail::continue_with_saved,
+				    stack);
+      };
+
+      // the end of the level, without the pointee
+      inline MemCompareInfo skip_pointee_mem_compare_info(IteratorStack& stack,
+							  const void* ){
+	auto saved = stack.pop_last<PointerCompareIterator>();
+	return MemCompareInfo{
+	  .next_obj = saved.next_obj,
+	    .continuation_fn = saved.continuation_fn,
+	    .obj  = nullptr,
+	    .size =0
+	    };
+      };
+
+      template<class P>
+      MemCompareInfo continue_pointer_mem_compare_info(IteratorStack& stack,
+						       const void* obj){
+	auto self = static_cast<const P*>(obj);
+	if ( not stack.get_last<PointerCompareIterator>().is_engaged ){
+	  return skip_pointee_mem_compare_info(stack, obj);
+	};
+	return MemCompareInfo{
+	  .next_obj = obj,
+	    .continuation_fn = continue_pointee_mem_compare_info<P>,
+	    .obj  = static_cast<const void*>(self->get()),
+	    .size = 0,
+	    .identity_skip_fn = skip_pointee_mem_compare_info
+	    };
+      };
+
+      template<class P>
+      MemCompareInfo get_pointer_mem_compare_info(const P* ptr,
+						  const void* next_obj,
+						  mem_compare_continuation_fn_t continuation_fn,
+						  IteratorStack& stack){
+	assert(ptr);
+	new (stack.get_new<PointerCompareIterator>()) PointerCompareIterator{
+	  .next_obj = next_obj,
+	    .continuation_fn = continuation_fn,
+	    .is_engaged = (*ptr) ? std::size_t(1) : std::size_t(0)};
+	auto& it = stack.get_last<PointerCompareIterator>();
+	return MemCompareInfo{
+	  .next_obj = static_cast<const void*>(ptr),
+	    .continuation_fn = continue_pointer_mem_compare_info<P>,
+	    .obj  = static_cast<const void*>(&(it.is_engaged)),
+	    .size =sizeof(std::size_t)
+	    };
+      };
+    }
+
+    template<class T>
+    MemCompareInfo get_mem_compare_info(const std::shared_ptr<const T>* ptr,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      return get_pointer_mem_compare_info(ptr, next_obj, continuation_fn, stack);
+    };
+
+    template<class T, class Deleter>
+    MemCompareInfo get_mem_compare_info(const std::unique_ptr<const T, Deleter>* ptr,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      return get_pointer_mem_compare_info(ptr, next_obj, continuation_fn, stack);
+    };
+  };
+}
+
+#endif //MEM_COMPARABLE_POINTER_HPP
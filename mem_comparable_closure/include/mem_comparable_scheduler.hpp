@@ -0,0 +1,234 @@
+#ifndef MEM_COMPARABLE_SCHEDULER_HPP
+#define MEM_COMPARABLE_SCHEDULER_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// WorkStealingPool
+namespace mem_comparable_closure{
+
+  // a thread pool which runs index based loops.
+  //   every participant (the workers and the calling thread) gets a contiguous
+  //   range of indices. A participant that runs out of work steals
+  //   the upper half of the range of another participant.
+  class WorkStealingPool{
+  private:
+    struct Range{
+      std::mutex mutex;
+      std::size_t begin = 0;
+      std::size_t end = 0;
+    };
+  public:
+    // the calling thread of parallel_for participates,
+    //   so n_workers = 0 runs everything on the calling thread.
+    explicit WorkStealingPool(std::size_t n_workers = default_worker_count())
+      :ranges(new Range[n_workers+1]), n_participants(n_workers+1){
+      this->workers.reserve(n_workers);
+      for (std::size_t i = 0; i< n_workers; ++i){
+	this->workers.emplace_back([this, i](){ this->worker_loop(i); });
+      };
+    };
+
+    WorkStealingPool(const WorkStealingPool& ) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool& ) = delete;
+
+    ~WorkStealingPool(){
+      {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->stop = true;
+      }
+      this->start_cv.notify_all();
+      for (auto& worker : this->workers){
+	worker.join();
+      };
+    };
+
+    // calls fn(i) for every i in [0,n) and returns when all calls have returned.
+    //   the first exception thrown by fn is rethrown here.
+    template<class F>
+    void parallel_for(std::size_t n, F fn){
+      std::lock_guard<std::mutex> call_lock(this->call_mutex);
+      const std::function<void(std::size_t)> job = std::move(fn);
+      for (std::size_t i = 0; i< this->n_participants; ++i){
+	std::lock_guard<std::mutex> lock(this->ranges[i].mutex);
+	this->ranges[i].begin = n*i/this->n_participants;
+	this->ranges[i].end = n*(i+1)/this->n_participants;
+      };
+      {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->job = &job;
+	this->error = nullptr;
+	this->running = this->workers.size();
+	++this->generation;
+      }
+      this->start_cv.notify_all();
+      // the calling thread is the last participant
+      this->run_tasks(this->n_participants-1);
+      std::exception_ptr error;
+      {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->done_cv.wait(lock, [this](){ return this->running == 0;});
+	this->job = nullptr;
+	error = this->error;
+      }
+      if (error) std::rethrow_exception(error);
+    };
+
+    std::size_t get_worker_count()const{return this->workers.size();};
+
+    static std::size_t default_worker_count(){
+      std::size_t n_threads = std::thread::hardware_concurrency();
+      return n_threads > 1 ? n_threads-1 : 0;
+    };
+  private:
+    void worker_loop(std::size_t id){
+      std::size_t seen_generation = 0;
+      while (true){
+	{
+	  std::unique_lock<std::mutex> lock(this->mutex);
+	  this->start_cv.wait(lock, [this, seen_generation](){
+	    return this->stop or this->generation != seen_generation;
+	  });
+	  if (this->stop) return;
+	  seen_generation = this->generation;
+	}
+	this->run_tasks(id);
+	{
+	  std::lock_guard<std::mutex> lock(this->mutex);
+	  --this->running;
+	  if (this->running == 0) this->done_cv.notify_all();
+	}
+      };
+    };
+
+    void run_tasks(std::size_t id){
+      std::size_t index;
+      while (this->pop(id, index) or this->steal(id, index)){
+	try{
+	  (*this->job)(index);
+	} catch (...){
+	  std::lock_guard<std::mutex> lock(this->mutex);
+	  if (!this->error) this->error = std::current_exception();
+	};
+      };
+    };
+
+    bool pop(std::size_t id, std::size_t& index){
+      Range& own = this->ranges[id];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (own.begin == own.end) return false;
+      index = own.begin;
+      ++own.begin;
+      return true;
+    };
+
+    bool steal(std::size_t id, std::size_t& index){
+      for (std::size_t i = 1; i< this->n_participants; ++i){
+	Range& victim = this->ranges[(id+i)%this->n_participants];
+	std::size_t begin;
+	std::size_t end;
+	{
+	  std::lock_guard<std::mutex> lock(victim.mutex);
+	  std::size_t remaining = victim.end - victim.begin;
+	  if (remaining == 0) continue;
+	  begin = victim.end - (remaining+1)/2;
+	  end = victim.end;
+	  victim.end = begin;
+	}
+	Range& own = this->ranges[id];
+	std::lock_guard<std::mutex> lock(own.mutex);
+	index = begin;
+	own.begin = begin+1;
+	own.end = end;
+	return true;
+      };
+      return false;
+    };
+
+    std::unique_ptr<Range[]> ranges;
+    std::size_t n_participants;
+    std::vector<std::thread> workers;
+
+    std::mutex call_mutex;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    std::size_t generation = 0;
+    std::size_t running = 0;
+    bool stop = false;
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::exception_ptr error;
+  };
+}
+
+// evaluate_incrementally
+namespace mem_comparable_closure{
+
+  // evaluates new_nodes.
+  //   node i is only invoked if it is updated compared to old_nodes[i],
+  //   otherwise old_results[i] is reused.
+  //   both the comparisons and the invocations run on the pool.
+  //   returns the number of invoked nodes.
+  template<class return_t>
+  std::size_t evaluate_incrementally(WorkStealingPool& pool,
+				     const std::vector<Function<return_t>>& old_nodes,
+				     const std::vector<return_t>& old_results,
+				     const std::vector<Function<return_t>>& new_nodes,
+				     std::vector<return_t>& new_results){
+    assert(old_nodes.size() == old_results.size());
+    std::vector<std::optional<return_t>> results(new_nodes.size());
+    std::atomic<std::size_t> invoked{0};
+    pool.parallel_for(new_nodes.size(), [&](std::size_t i){
+      if (i < old_nodes.size() and is_identical(old_nodes[i], new_nodes[i])){
+	results[i].emplace(old_results[i]);
+      } else {
+	results[i].emplace(new_nodes[i]());
+	invoked.fetch_add(1, std::memory_order_relaxed);
+      };
+    });
+    new_results.clear();
+    new_results.reserve(results.size());
+    for (auto& result : results){
+      new_results.push_back(std::move(*result));
+    };
+    return invoked.load();
+  };
+
+  // keeps the nodes and results of the last evaluation
+  template<class return_t>
+  class IncrementalEvaluator{
+  private:
+    using function_t = Function<return_t>;
+  public:
+    explicit IncrementalEvaluator(WorkStealingPool& pool):pool(&pool){};
+
+    const std::vector<return_t>& evaluate(std::vector<function_t> nodes){
+      std::vector<return_t> results;
+      this->invoked_count = evaluate_incrementally(*this->pool,
+						   this->nodes,
+						   this->results,
+						   nodes,
+						   results);
+      this->nodes = std::move(nodes);
+      this->results = std::move(results);
+      return this->results;
+    };
+
+    const std::vector<return_t>& get_results()const{return this->results;};
+    // the number of nodes invoked by the last evaluate
+    std::size_t get_invoked_count()const{return this->invoked_count;};
+  private:
+    WorkStealingPool* pool;
+    std::vector<function_t> nodes;
+    std::vector<return_t> results;
+    std::size_t invoked_count = 0;
+  };
+}
+
+#endif //MEM_COMPARABLE_SCHEDULER_HPP
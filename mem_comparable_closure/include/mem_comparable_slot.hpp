@@ -0,0 +1,108 @@
+#ifndef MEM_COMPARABLE_SLOT_HPP
+#define MEM_COMPARABLE_SLOT_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// ClosureSlot
+namespace mem_comparable_closure{
+
+  // a ClosureSlot hands Functions from producer threads to consumer threads.
+  //   the current Function is held by a shared_ptr which is swapped atomically,
+  //   a consumer keeps the Function it loaded alive even if a new one is published.
+  //   publishing a Function identical to the current one is skipped.
+  //   every successful publish increments the generation,
+  //   so a consumer can detect "nothing changed" without a comparison.
+  //   the generation is stored with the Function, so it never refers to an older Function.
+  //   it is also published to an atomic counter after the Function,
+  //   so a consumer that finds nothing changed doesn't load the shared_ptr
+  //   (an atomic shared_ptr load takes a lock in libstdc++).
+  //   the counter may trail a publish for a moment, the change is seen by the next check.
+  template<class return_t, class ...Args_t>
+  class ClosureSlot{
+  public:
+    using function_t = Function<return_t, Args_t...>;
+    using pointer_t = std::shared_ptr<const function_t>;
+
+    ClosureSlot() = default;
+    explicit ClosureSlot(function_t fun)
+      :current(std::make_shared<const Entry>(Entry{std::move(fun), 1})), generation(1){};
+    ClosureSlot(const ClosureSlot<return_t, Args_t...>& ) = delete;
+    ClosureSlot<return_t, Args_t...>& operator=(const ClosureSlot<return_t, Args_t...>& ) = delete;
+
+    // returns false if fun is identical to the current Function (nothing is published)
+    bool publish(function_t fun){
+      entry_pointer_t expected = std::atomic_load_explicit(&this->current, std::memory_order_acquire);
+      if (expected and is_identical(expected->fun, fun)) return false;
+      auto entry = std::make_shared<Entry>(Entry{std::move(fun), 0});
+      entry_pointer_t desired = entry;
+      while (true){
+	// not visible to other threads before the exchange
+	entry->generation = expected ? expected->generation + 1 : 1;
+	if (std::atomic_compare_exchange_weak_explicit(&this->current,
+						       &expected,
+						       desired,
+						       std::memory_order_acq_rel,
+						       std::memory_order_acquire)){
+	  this->publish_generation(entry->generation);
+	  return true;
+	};
+	// another producer was faster
+	if (expected and is_identical(expected->fun, entry->fun)) return false;
+      };
+    };
+
+    // the current Function or nullptr if nothing was published yet
+    pointer_t load()const{
+      return to_pointer(std::atomic_load_explicit(&this->current, std::memory_order_acquire));
+    };
+
+    // if the generation differs from seen_generation, loads the current Function into fun,
+    //   updates seen_generation and returns true.
+    //   fun is the Function of seen_generation.
+    bool load_if_changed(std::uint64_t& seen_generation, pointer_t& fun)const{
+      if (this->generation.load(std::memory_order_acquire) == seen_generation) return false;
+      entry_pointer_t entry = std::atomic_load_explicit(&this->current, std::memory_order_acquire);
+      // the counter trailed an earlier load of this entry
+      const std::uint64_t current_generation = entry ? entry->generation : 0;
+      if (current_generation == seen_generation) return false;
+      fun = to_pointer(std::move(entry));
+      seen_generation = current_generation;
+      return true;
+    };
+
+    // the generation of the Function last published (it may trail load() for a moment)
+    std::uint64_t get_generation()const{
+      return this->generation.load(std::memory_order_acquire);
+    };
+  private:
+    struct Entry{
+      function_t fun;
+      std::uint64_t generation;
+    };
+    using entry_pointer_t = std::shared_ptr<const Entry>;
+
+    // shares the ownership of the entry
+    static pointer_t to_pointer(entry_pointer_t entry){
+      if (not entry) return nullptr;
+      const function_t* fun = &(entry->fun);
+      return pointer_t(std::move(entry), fun);
+    };
+
+    // the counter only grows, even if producers finish their publishes out of order
+    void publish_generation(std::uint64_t new_generation){
+      std::uint64_t published = this->generation.load(std::memory_order_relaxed);
+      while (published < new_generation
+	     and not this->generation.compare_exchange_weak(published, new_generation,
+							    std::memory_order_release,
+							    std::memory_order_relaxed)){};
+    };
+
+    entry_pointer_t current;
+    std::atomic<std::uint64_t> generation{0};
+  };
+}
+
+#endif //MEM_COMPARABLE_SLOT_HPP
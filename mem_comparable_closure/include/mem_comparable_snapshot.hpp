@@ -0,0 +1,90 @@
+#ifndef MEM_COMPARABLE_SNAPSHOT_HPP
+#define MEM_COMPARABLE_SNAPSHOT_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <vector>
+
+// Snapshot
+namespace mem_comparable_closure{
+
+  // a Snapshot is an owned copy of the chunk stream of an object
+  //   (what is_identical compares), not of the object itself.
+  //   an object can be compared against the Snapshot after the original object is gone.
+  //   each chunk is stored as its size followed by its bytes,
+  //   the end of a level only as level_end.
+  //   note: function pointers are part of the stream,
+  //   so a Snapshot is only meaningful within one process.
+  template<class T>
+  class Snapshot{
+  private:
+    static constexpr std::size_t level_end = static_cast<std::size_t>(-1);
+  public:
+    explicit Snapshot(const T& obj){
+      std::uint64_t hash = detail::hash_offset_basis;
+      algorithm::for_each_chunk(obj, [this, &hash](const void* chunk, std::size_t size){
+	hash = detail::hash_chunk(hash, chunk, size);
+	this->append(chunk ? size : level_end);
+	if (chunk){
+	  auto bytes = static_cast<const unsigned char*>(chunk);
+	  this->stream.insert(this->stream.end(), bytes, bytes+size);
+	};
+	return true;
+      });
+      this->stream.shrink_to_fit();
+      this->hash = static_cast<std::size_t>(hash);
+    };
+
+    // compares obj against the recorded stream
+    bool is_identical_to(const T& obj)const{
+      std::size_t position = 0;
+      bool is_identical = algorithm::for_each_chunk(obj, [this, &position](const void* chunk, std::size_t size){
+	std::size_t recorded_size;
+	if (not this->read(position, recorded_size)) return false;
+	if (not chunk) return recorded_size == level_end;
+	if (recorded_size != size) return false;
+	if (this->stream.size() - position < size) return false;
+	if (std::memcmp(this->stream.data()+position, chunk, size) != 0) return false;
+	position += size;
+	return true;
+      });
+      return is_identical and position == this->stream.size();
+    };
+
+    // the same as structural_hash of the original object
+    std::size_t get_hash()const{return this->hash;};
+    // the size of the recorded stream in bytes
+    std::size_t get_size()const{return this->stream.size();};
+  private:
+    void append(std::size_t value){
+      auto bytes = reinterpret_cast<const unsigned char*>(&value);
+      this->stream.insert(this->stream.end(), bytes, bytes+sizeof(value));
+    };
+
+    bool read(std::size_t& position, std::size_t& value)const{
+      if (this->stream.size() - position < sizeof(value)) return false;
+      std::memcpy(&value, this->stream.data()+position, sizeof(value));
+      position += sizeof(value);
+      return true;
+    };
+
+    std::vector<unsigned char> stream;
+    std::size_t hash;
+  };
+
+  template<class T>
+  Snapshot<T> snapshot(const T& obj){
+    return Snapshot<T>(obj);
+  };
+
+  template<class T>
+  bool is_identical(const Snapshot<T>& snapshot, const T& obj){
+    return snapshot.is_identical_to(obj);
+  };
+
+  template<class T>
+  bool is_identical(const T& obj, const Snapshot<T>& snapshot){
+    return snapshot.is_identical_to(obj);
+  };
+}
+
+#endif //MEM_COMPARABLE_SNAPSHOT_HPP
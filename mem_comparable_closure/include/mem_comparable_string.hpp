@@ -0,0 +1,128 @@
+#ifndef MEM_COMPARABLE_STRING_HPP
+#define MEM_COMPARABLE_STRING_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <string>
+#include <string_view>
+
+namespace mem_comparable_closure{
+  template<class CharT, class Traits, class Alloc>
+  struct concepts::is_specialized<std::basic_string<CharT, Traits, Alloc>> : std::true_type{};
+
+  // a string_view is compared by the characters it views.
+  //   it is bound into a closure as the view, the characters are not copied:
+  //   they have to outlive every closure the view is bound to
+  //   and must not change while it is viewed.
+  //   bind a std::basic_string to own the characters.
+  template<class CharT, class Traits>
+  struct concepts::is_specialized<std::basic_string_view<CharT, Traits>> : std::true_type{};
+
+  // strings are compared by their length followed by their characters.
+  //   a short string (which usually lives in the small string buffer)
+  //   is copied together with its length into bytes and compared as a single chunk,
+  //   a long string as the length followed by the characters in place.
+  //   the chunking only depends on the length, so equal strings give equal chunk streams.
+  struct StringCompareIterator{
+    static constexpr std::size_t short_string_bytes = 16;
+
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    const void* characters;
+    std::size_t characters_size;
+    std::size_t length;
+    unsigned char bytes[sizeof(std::size_t)+short_string_bytes];
+  };
+
+  namespace algorithm {
+    namespace{
+      inline MemCompareInfo continue_string_mem_compare_info(IteratorStack& stack,
+							     const void* obj){
+	auto& it = stack.get_last<StringCompareIterator>();
+	if ( it.characters ){
+	  const void* characters = it.characters;
+	  it.characters = nullptr;
+	  return MemCompareInfo{
+	    .next_obj = obj,
+	      .continuation_fn = continue_string_mem_compare_info,
+	      .obj  = characters,
+	      .size = it.characters_size
+	      };
+	};
+	auto saved = stack.pop_last<StringCompareIterator>();
+	return MemCompareInfo{
+	  .next_obj = saved.next_obj,
+	    .continuation_fn = saved.continuation_fn,
+	    .obj  = nullptr,
+	    .size =0
+	    };
+      };
+
+      template<class CharT>
+      MemCompareInfo get_string_mem_compare_info(const void* self,
+						 const CharT* data,
+						 std::size_t length,
+						 const void* next_obj,
+						 mem_compare_continuation_fn_t continuation_fn,
+						 IteratorStack& stack){
+	static_assert(concepts::is_trivial<CharT>::value, "the characters have to be trivial");
+	const std::size_t characters_size = length*sizeof(CharT);
+	new (stack.get_new<StringCompareIterator>()) StringCompareIterator{
+	  .next_obj = next_obj,
+	    .continuation_fn = continuation_fn,
+	    .characters = nullptr,
+	    .characters_size = characters_size,
+	    .length = length,
+	    .bytes = {}};
+	auto& it = stack.get_last<StringCompareIterator>();
+	if ( characters_size <= StringCompareIterator::short_string_bytes ){
+	  std::memcpy(it.bytes, &length, sizeof(std::size_t));
+	  if (characters_size > 0) std::memcpy(it.bytes+sizeof(std::size_t), data, characters_size);
+	  return MemCompareInfo{
+	    .next_obj = self,
+	      .continuation_fn = continue_string_mem_compare_info,
+	      .obj  = static_cast<const void*>(it.bytes),
+	      .size = sizeof(std::size_t)+characters_size
+	      };
+	};
+	it.characters = static_cast<const void*>(data);
+	return MemCompareInfo{
+	  .next_obj = self,
+	    .continuation_fn = continue_string_mem_compare_info,
+	    .obj  = static_cast<const void*>(&(it.length)),
+	    .size = sizeof(std::size_t)
+	    };
+      };
+    }
+
+    template<class CharT, class Traits, class Alloc>
+    MemCompareInfo get_mem_compare_info(const std::basic_string<CharT, Traits, Alloc>* str,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      assert(str);
+      return get_string_mem_compare_info(static_cast<const void*>(str),
+					 str->data(),
+					 str->size(),
+					 next_obj,
+					 continuation_fn,
+					 stack);
+    };
+
+    template<class CharT, class Traits>
+    MemCompareInfo get_mem_compare_info(const std::basic_string_view<CharT, Traits>* str,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      assert(str);
+      return get_string_mem_compare_info(static_cast<const void*>(str),
+					 str->data(),
+					 str->size(),
+					 next_obj,
+					 continuation_fn,
+					 stack);
+    };
+  };
+}
+
+#endif //MEM_COMPARABLE_STRING_HPP
@@ -0,0 +1,241 @@
+#ifndef MEM_COMPARABLE_UNORDERED_HPP
+#define MEM_COMPARABLE_UNORDERED_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace mem_comparable_closure{
+  template<class Key, class Hash, class KeyEqual, class Alloc>
+  struct concepts::is_specialized<std::unordered_set<Key, Hash, KeyEqual, Alloc>>
+    : concepts::is_transparent<Key>{};
+
+  template<class Key, class Hash, class KeyEqual, class Alloc>
+  struct concepts::is_specialized<std::unordered_multiset<Key, Hash, KeyEqual, Alloc>>
+    : concepts::is_transparent<Key>{};
+
+  template<class Key, class T, class Hash, class KeyEqual, class Alloc>
+  struct concepts::is_specialized<std::unordered_map<Key, T, Hash, KeyEqual, Alloc>>
+    : std::conjunction<concepts::is_transparent<Key>, concepts::is_transparent<T>>{};
+
+  template<class Key, class T, class Hash, class KeyEqual, class Alloc>
+  struct concepts::is_specialized<std::unordered_multimap<Key, T, Hash, KeyEqual, Alloc>>
+    : std::conjunction<concepts::is_transparent<Key>, concepts::is_transparent<T>>{};
+
+  // the iteration order of equal hash containers can differ,
+  //   so their elements are compared in a canonical order: sorted by their structural_hash.
+  //   the stream is the size, the sorted hashes as a single chunk (a cheap reject)
+  //   and then the elements in the same order (confirming the hashes).
+  //   the sorted (hash, element) entries and the hashes live on the IteratorStack.
+  //   elements with colliding hashes are ordered by their chunk streams,
+  //   so the order stays canonical.
+  struct UnorderedCompareIterator{
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    std::size_t size;
+    std::size_t entries_offset;
+    std::size_t hashes_offset;
+    // 0 is the hashes, 1+i is element i (or for a map 1+2i the key and 2+2i the mapped value)
+    std::size_t next_step;
+  };
+
+  struct UnorderedEntry{
+    std::size_t hash;
+    const void* element;
+  };
+
+  namespace algorithm {
+    namespace{
+      template<class Container>
+      constexpr bool is_map(){
+	return not std::is_same<typename Container::key_type,
+				typename Container::value_type>::value;
+      };
+
+      // orders two objects by their chunk streams (the chunks structural_hash hashes).
+      //   a level end orders before a chunk, chunks are ordered by their size, then their bytes.
+      //   returns <0, 0 or >0. the stacks have to be empty and are cleared afterwards.
+      template<class T>
+      int compare_chunk_streams(const T& obj1, const T& obj2,
+				IteratorStack& stack1, IteratorStack& stack2){
+	MemCompareInfo info1 = get_root_mem_compare_info(&obj1, stack1);
+	MemCompareInfo info2 = get_root_mem_compare_info(&obj2, stack2);
+	int order = 0;
+	while (true){
+	  // an identity is always descended into
+	  while (info1.next_obj and info1.identity_skip_fn) info1 = info1.continuation_fn(stack1, info1.next_obj);
+	  while (info2.next_obj and info2.identity_skip_fn) info2 = info2.continuation_fn(stack2, info2.next_obj);
+	  if (not info1.next_obj or not info2.next_obj){
+	    order = (info1.next_obj ? 1 : 0) - (info2.next_obj ? 1 : 0);
+	    break;
+	  };
+	  if (not info1.obj or not info2.obj){
+	    order = (info1.obj ? 1 : 0) - (info2.obj ? 1 : 0);
+	  } else if (info1.size != info2.size){
+	    order = info1.size < info2.size ? -1 : 1;
+	  } else if (info1.size > 0){
+	    order = std::memcmp(info1.obj, info2.obj, info1.size);
+	  };
+	  if (order != 0) break;
+	  info1 = info1.continuation_fn(stack1, info1.next_obj);
+	  info2 = info2.continuation_fn(stack2, info2.next_obj);
+	};
+	stack1.clear();
+	stack2.clear();
+	return order;
+      };
+
+      template<class Container>
+      bool is_canonically_less(const UnorderedEntry& a, const UnorderedEntry& b,
+			       IteratorStack& stack1, IteratorStack& stack2){
+	using value_t = typename Container::value_type;
+	if (a.hash != b.hash) return a.hash < b.hash;
+	auto element1 = static_cast<const value_t*>(a.element);
+	auto element2 = static_cast<const value_t*>(b.element);
+	if constexpr (is_map<Container>()){
+	  int order = compare_chunk_streams(element1->first, element2->first, stack1, stack2);
+	  if (order != 0) return order < 0;
+	  return compare_chunk_streams(element1->second, element2->second, stack1, stack2) < 0;
+	} else {
+	  return compare_chunk_streams(*element1, *element2, stack1, stack2) < 0;
+	};
+      };
+
+      template<class Container>
+      MemCompareInfo continue_unordered_mem_compare_info(IteratorStack& stack,
+							 const void* obj){
+	using value_t = typename Container::value_type;
+	constexpr std::size_t steps_per_element = is_map<Container>() ? 2 : 1;
+	auto& it = stack.get_last<UnorderedCompareIterator>();
+	if ( it.next_step == 0 and it.size > 0 ){
+	  it.next_step = 1;
+	  return MemCompareInfo{
+	    .next_obj = obj,
+	      .continuation_fn = continue_unordered_mem_compare_info<Container>,
+	      .obj  = static_cast<const void*>(stack.get_array_at<std::size_t>(it.hashes_offset)),
+	      .size = it.size*sizeof(std::size_t)
+	      };
+	};
+	if ( it.next_step == 0 or it.next_step > it.size*steps_per_element ){
+	  auto saved = stack.pop_last<UnorderedCompareIterator>();
+	  stack.pop_last_array<std::size_t>(saved.size);
+	  stack.pop_last_array<UnorderedEntry>(saved.size);
+	  return MemCompareInfo{
+	    .next_obj = saved.next_obj,
+	      .continuation_fn = saved.continuation_fn,
+	      .obj  = nullptr,
+	      .size =0
+	      };
+	};
+	const std::size_t step = it.next_step-1;
+	it.next_step = it.next_step+1;
+	auto entries = stack.get_array_at<UnorderedEntry>(it.entries_offset);
+	auto element = static_cast<const value_t*>(entries[step/steps_per_element].element);
+	if constexpr (is_map<Container>()){
+	  if (step%2 == 0){
+	    return get_mem_compare_info(&(element->first),
+					obj,
+					continue_unordered_mem_compare_info<Container>,
+					stack);
+	  };
+	  return get_mem_compare_info(&(element->second),
+				      obj,
+				      continue_unordered_mem_compare_info<Container>,
+				      stack);
+	} else {
+	  return get_mem_compare_info(element,
+				      obj,
+				      continue_unordered_mem_compare_info<Container>,
+				      stack);
+	};
+      };
+
+      template<class Container>
+      MemCompareInfo get_unordered_mem_compare_info(const Container* container,
+						    const void* next_obj,
+						    mem_compare_continuation_fn_t continuation_fn,
+						    IteratorStack& stack){
+	assert(container);
+	const std::size_t size = container->size();
+	const std::size_t entries_offset = stack.get_new_array<UnorderedEntry>(size);
+	const std::size_t hashes_offset = stack.get_new_array<std::size_t>(size);
+	auto entries = stack.get_array_at<UnorderedEntry>(entries_offset);
+	// the nested walks use the function ids of the stack, too
+	auto walk_stack1 = IteratorStack{};
+	auto walk_stack2 = IteratorStack{};
+	walk_stack1.set_function_id_fn(stack.get_function_id_fn());
+	walk_stack2.set_function_id_fn(stack.get_function_id_fn());
+	std::size_t i = 0;
+	for (const auto& element : *container){
+	  std::size_t hash;
+	  if constexpr (is_map<Container>()){
+	    hash = hash_combine(mem_comparable_closure::detail::hash_walk(element.first, walk_stack1),
+				mem_comparable_closure::detail::hash_walk(element.second, walk_stack1));
+	  } else {
+	    hash = mem_comparable_closure::detail::hash_walk(element, walk_stack1);
+	  };
+	  new (entries+i) UnorderedEntry{hash, static_cast<const void*>(&element)};
+	  ++i;
+	};
+	std::sort(entries, entries+size, [&walk_stack1, &walk_stack2](const UnorderedEntry& a, const UnorderedEntry& b){
+	  return is_canonically_less<Container>(a, b, walk_stack1, walk_stack2);
+	});
+	auto hashes = stack.get_array_at<std::size_t>(hashes_offset);
+	for (std::size_t k = 0; k< size; ++k){
+	  hashes[k] = entries[k].hash;
+	};
+	new (stack.get_new<UnorderedCompareIterator>()) UnorderedCompareIterator{
+	  .next_obj = next_obj,
+	    .continuation_fn = continuation_fn,
+	    .size = size,
+	    .entries_offset = entries_offset,
+	    .hashes_offset = hashes_offset,
+	    .next_step = 0};
+	auto& it = stack.get_last<UnorderedCompareIterator>();
+	return MemCompareInfo{
+	  .next_obj = static_cast<const void*>(container),
+	    .continuation_fn = continue_unordered_mem_compare_info<Container>,
+	    .obj  = static_cast<const void*>(&(it.size)),
+	    .size =sizeof(std::size_t)
+	    };
+      };
+    }
+
+    template<class Key, class Hash, class KeyEqual, class Alloc>
+    MemCompareInfo get_mem_compare_info(const std::unordered_set<Key, Hash, KeyEqual, Alloc>* container,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      return get_unordered_mem_compare_info(container, next_obj, continuation_fn, stack);
+    };
+
+    template<class Key, class Hash, class KeyEqual, class Alloc>
+    MemCompareInfo get_mem_compare_info(const std::unordered_multiset<Key, Hash, KeyEqual, Alloc>* container,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      return get_unordered_mem_compare_info(container, next_obj, continuation_fn, stack);
+    };
+
+    template<class Key, class T, class Hash, class KeyEqual, class Alloc>
+    MemCompareInfo get_mem_compare_info(const std::unordered_map<Key, T, Hash, KeyEqual, Alloc>* container,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      return get_unordered_mem_compare_info(container, next_obj, continuation_fn, stack);
+    };
+
+    template<class Key, class T, class Hash, class KeyEqual, class Alloc>
+    MemCompareInfo get_mem_compare_info(const std::unordered_multimap<Key, T, Hash, KeyEqual, Alloc>* container,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      return get_unordered_mem_compare_info(container, next_obj, continuation_fn, stack);
+    };
+  };
+}
+
+#endif //MEM_COMPARABLE_UNORDERED_HPP
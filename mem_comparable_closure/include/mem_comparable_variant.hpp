@@ -0,0 +1,131 @@
+#ifndef MEM_COMPARABLE_VARIANT_HPP
+#define MEM_COMPARABLE_VARIANT_HPP
+
+#include "mem_comparable_closure.hpp"
+#include <optional>
+#include <variant>
+
+namespace mem_comparable_closure{
+  template<class T>
+  struct concepts::is_specialized<std::optional<T>> : concepts::is_transparent<T>{};
+
+  template<class ...T>
+  struct concepts::is_specialized<std::variant<T...>> : std::conjunction<concepts::is_transparent<T>...>{};
+
+  // std::optional and std::variant are compared by their discriminator first
+  //   (0 or 1 for an optional, index() for a variant)
+  //   followed by the active alternative (if any) and a level end.
+  //   different discriminators are rejected on the first chunk.
+  struct DiscriminatorCompareIterator{
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    std::size_t discriminator;
+  };
+
+  namespace algorithm {
+    namespace{
+      // replaces the DiscriminatorCompareIterator by a ComparisonIteratorBase
+      //   and continues with alternative (or ends the level if there is none).
+      template<class A>
+      MemCompareInfo continue_with_alternative(IteratorStack& stack,
+					       const void* obj,
+					       const A* alternative){
+	auto saved = stack.pop_last<DiscriminatorCompareIterator>();
+	if ( not alternative ){
+	  return MemCompareInfo{
+	    .next_obj = saved.next_obj,
+	      .continuation_fn = saved.continuation_fn,
+	      .obj  = nullptr,
+	      .size =0
+	      };
+	};
+	new (stack.get_new<detail::ComparisonIteratorBase>( )) detail::ComparisonIteratorBase{
+	  .next_obj = saved.next_obj,
+	    .continuation_fn = saved.continuation_fn
+	    };
+	return get_mem_compare_info(alternative,
+				    obj,
+				    detail::continue_with_saved,
+				    stack);
+      };
+
+      template<class T>
+      MemCompareInfo continue_optional_mem_compare_info(IteratorStack& stack,
+							const void* obj){
+	auto self = static_cast<const std::optional<T>*>(obj);
+	return continue_with_alternative(stack, obj, self->has_value() ? &(**self) : nullptr);
+      };
+
+      template<std::size_t i, class ...T>
+      MemCompareInfo continue_variant_alternative(IteratorStack& stack,
+						  const void* obj){
+	auto self = static_cast<const std::variant<T...>*>(obj);
+	return continue_with_alternative(stack, obj, std::get_if<i>(self));
+      };
+
+      // a valueless variant has nothing to compare after its index
+      template<class ...T>
+      MemCompareInfo continue_valueless_variant(IteratorStack& stack,
+						const void* obj){
+	return continue_with_alternative<int>(stack, obj, nullptr);
+      };
+
+      // the jump table of continuations, indexed by index()
+      template<class indices, class ...T>
+      struct VariantJumpTable;
+
+      template<std::size_t ...i, class ...T>
+      struct VariantJumpTable<std::index_sequence<i...>, T...>{
+	static constexpr mem_compare_continuation_fn_t table[] = {
+	  continue_variant_alternative<i, T...>...};
+      };
+
+      template<class ...T>
+      constexpr mem_compare_continuation_fn_t variant_continuation(std::size_t index){
+	if (index == std::variant_npos) return continue_valueless_variant<T...>;
+	return VariantJumpTable<std::index_sequence_for<T...>, T...>::table[index];
+      };
+    }
+
+    template<class T>
+    MemCompareInfo get_mem_compare_info(const std::optional<T>* opt,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      assert(opt);
+      new (stack.get_new<DiscriminatorCompareIterator>()) DiscriminatorCompareIterator{
+	.next_obj = next_obj,
+	  .continuation_fn = continuation_fn,
+	  .discriminator = opt->has_value() ? std::size_t(1) : std::size_t(0)};
+      auto& it = stack.get_last<DiscriminatorCompareIterator>();
+      return MemCompareInfo{
+	.next_obj = static_cast<const void*>(opt),
+	  .continuation_fn = continue_optional_mem_compare_info<T>,
+	  .obj  = static_cast<const void*>(&(it.discriminator)),
+	  .size =sizeof(std::size_t)
+	  };
+    };
+
+    template<class ...T>
+    MemCompareInfo get_mem_compare_info(const std::variant<T...>* var,
+					const void* next_obj,
+					mem_compare_continuation_fn_t continuation_fn,
+				        IteratorStack& stack){
+      assert(var);
+      new (stack.get_new<DiscriminatorCompareIterator>()) DiscriminatorCompareIterator{
+	.next_obj = next_obj,
+	  .continuation_fn = continuation_fn,
+	  .discriminator = var->index()};
+      auto& it = stack.get_last<DiscriminatorCompareIterator>();
+      return MemCompareInfo{
+	.next_obj = static_cast<const void*>(var),
+	  .continuation_fn = variant_continuation<T...>(var->index()),
+	  .obj  = static_cast<const void*>(&(it.discriminator)),
+	  .size =sizeof(std::size_t)
+	  };
+    };
+  };
+}
+
+#endif //MEM_COMPARABLE_VARIANT_HPP
@@ -2,6 +2,8 @@
 #define MEM_COMPARABLE_VECTOR_HPP
 
 #include "mem_comparable_closure.hpp"
+#include <algorithm>
+#include <climits>
 #include <vector>
 
 namespace mem_comparable_closure{
@@ -15,6 +17,82 @@ namespace mem_comparable_closure{
     std::size_t next_element;
     std::size_t size;
   };
+
+  // vectors of flat elements (see concepts::is_flat) are compared in blocks.
+  //   the fields (or members) of up to elements_per_block elements are gathered
+  //   (without their padding) into a buffer on the IteratorStack and compared as a single chunk,
+  //   instead of returning to the driver loop for every field.
+  //   the elements of any other vector are still compared one by one, e.g. protocol_compatible
+  //   elements, or elements with a vector field. gathering costs a copy,
+  //   so a block compares at about half the speed of a hand written field by field loop.
+  struct VectorBlockCompareIterator{
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    std::size_t next_element;
+    std::size_t size;
+    std::size_t buffer_offset;
+    std::size_t buffer_size;
+  };
+
+  namespace concepts{
+    namespace detail{
+      template<class T>
+      constexpr bool has_only_trivial_fields(){
+	constexpr auto& layout = algorithm::detail::field_layout<T, false>;
+	for (std::size_t k = 0; k< layout.segment_count; ++k){
+	  if (not layout.segment_is_run[k]) return false;
+	};
+	return true;
+      };
+    }
+
+    namespace detail{
+      template<class Tuple>
+      struct are_trivial_member_pointers : std::false_type{};
+
+      template<class ...Member_t>
+      struct are_trivial_member_pointers<std::tuple<Member_t...>> : std::conjunction<
+	std::is_pointer<Member_t>...,
+	is_trivial<typename std::remove_cv<typename std::remove_pointer<Member_t>::type>::type>...
+	>{};
+
+      template<class T, class = void>
+      struct has_only_trivial_members : std::false_type{};
+
+      template<class T>
+      struct has_only_trivial_members<T, std::void_t<decltype(std::declval<const T&>().get_member_access())>>
+	: are_trivial_member_pointers<decltype(std::declval<const T&>().get_member_access())>{};
+    }
+
+    // a reflected aggregate of trivial fields, e.g. a struct with padding,
+    //   or a member_accessible type whose members are all trivial.
+    //   its compare stream is a fixed number of bytes.
+    template<class T, class = void>
+    struct is_flat : std::false_type{};
+
+    template<class T>
+    struct is_flat<T, typename std::enable_if<is_aggregate_reflectable<T>::value>::type>
+      : std::integral_constant<bool, detail::has_only_trivial_fields<T>()>{};
+
+    template<class T>
+    struct is_flat<T, typename std::enable_if<is_member_accessible<T>::value
+					       and not is_trivial<T>::value>::type>
+      : detail::has_only_trivial_members<T>{};
+  }
+
+  // std::vector<bool> is compared word by word.
+  //   the packed words of the bits are not accessible in a portable way,
+  //   so only libstdc++ compares its full words in place.
+  //   any other (partial) word is packed into word, unused bits are zero.
+  struct VectorBoolCompareIterator{
+    const void * next_obj;
+    mem_compare_continuation_fn_t  continuation_fn;
+
+    std::size_t next_bit;
+    std::size_t size;
+    std::uint64_t word;
+  };
   
   namespace algorithm {
     namespace{
@@ -24,7 +102,7 @@ namespace mem_comparable_closure{
 	continue_vector_mem_compare_info(IteratorStack& stack,
 					 const void* obj){
 	auto self = static_cast< const std::vector<T,Alloc>*>( obj);
-	auto it = stack.get_last<VectorCompareIterator>();
+	auto& it = stack.get_last<VectorCompareIterator>();
 	if ( it.next_element == self->size()  ){
 	  auto it = stack.pop_last<VectorCompareIterator>();
 	  return MemCompareInfo{
@@ -45,13 +123,135 @@ namespace mem_comparable_closure{
 	};
       };
 
+      // the block size in bytes of the gathered fields
+      constexpr std::size_t vector_block_size = 4096;
+      // how many elements ahead the elements of a vector are prefetched
+      constexpr std::size_t vector_prefetch_distance = 8;
+
+      inline void prefetch(const void* address){
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(address);
+#else
+	(void) address;
+#endif
+      };
+
+      template<class Tuple, std::size_t ...member>
+      constexpr std::size_t members_size(std::index_sequence<member...>){
+	return (std::size_t(0) + ... + sizeof(*std::get<member>(std::declval<Tuple>())));
+      };
+
+      // the number of bytes of the fields (or members) of a flat T
+      template<class T>
+      constexpr std::size_t flat_size(){
+	if constexpr (concepts::is_member_accessible<T>::value){
+	  using tuple_t = decltype(std::declval<const T&>().get_member_access());
+	  return members_size<tuple_t>(std::make_index_sequence<std::tuple_size<tuple_t>::value>{});
+	} else {
+	  constexpr auto& layout = detail::field_layout<T, false>;
+	  std::size_t size = 0;
+	  for (std::size_t k = 0; k< layout.segment_count; ++k){
+	    size += layout.segment_size[k];
+	  };
+	  return size;
+	};
+      };
+
+      template<class T>
+      constexpr std::size_t elements_per_block(){
+	return std::max<std::size_t>(1, vector_block_size/flat_size<T>());
+      };
+
+      // copies the segments of obj to out, returns the end of the copied bytes
+      template<class T, bool coalesce, std::size_t ...segment>
+      char* gather_segments(const T& obj, char* out, std::index_sequence<segment...>){
+	constexpr auto& layout = detail::field_layout<T, coalesce>;
+	auto fields = reflection::get_field_pointers(obj);
+	((std::memcpy(out,
+		      std::get<layout.segment_first_field[segment]>(fields),
+		      layout.segment_size[segment]),
+	  out += layout.segment_size[segment]), ...);
+	return out;
+      };
+
+      // copies the members of obj to out, returns the end of the copied bytes
+      template<class T, std::size_t ...member>
+      char* gather_members(const T& obj, char* out, std::index_sequence<member...>){
+	auto members = obj.get_member_access();
+	((std::memcpy(out, std::get<member>(members), sizeof(*std::get<member>(members))),
+	  out += sizeof(*std::get<member>(members))), ...);
+	return out;
+      };
+
+      // the fields (or members) of count elements, without their padding
+      template<class T>
+      void gather_elements(const T* elements, std::size_t count, char* out){
+	if constexpr (concepts::is_member_accessible<T>::value){
+	  using tuple_t = decltype(elements->get_member_access());
+	  for (std::size_t i = 0; i< count; ++i){
+	    out = gather_members(elements[i], out, std::make_index_sequence<std::tuple_size<tuple_t>::value>{});
+	  };
+	} else {
+	  // coalesced and not coalesced segments give the same bytes,
+	  //   the coalesced ones need the expected layout
+	  static const bool is_expected_layout =
+	    detail::is_expected_field_layout(*elements, std::make_index_sequence<reflection::field_count<T>()>{});
+	  if (is_expected_layout){
+	    for (std::size_t i = 0; i< count; ++i){
+	      out = gather_segments<T, true>(elements[i], out,
+					     std::make_index_sequence<detail::field_layout<T, true>.segment_count>{});
+	    };
+	  } else {
+	    for (std::size_t i = 0; i< count; ++i){
+	      out = gather_segments<T, false>(elements[i], out,
+					      std::make_index_sequence<detail::field_layout<T, false>.segment_count>{});
+	    };
+	  };
+	};
+      };
+
+      template <class T, class Alloc>
+      MemCompareInfo continue_vector_block_mem_compare_info(IteratorStack& stack,
+							    const void* obj){
+	auto self = static_cast< const std::vector<T,Alloc>*>( obj);
+	auto& it = stack.get_last<VectorBlockCompareIterator>();
+	if ( it.next_element == it.size ){
+	  auto saved = stack.pop_last<VectorBlockCompareIterator>();
+	  stack.pop_last_array<char>(saved.buffer_size);
+	  return MemCompareInfo{
+	    .next_obj = saved.next_obj,
+	      .continuation_fn = saved.continuation_fn,
+	      .obj  = nullptr,
+	      .size =0
+	      };
+	};
+	const std::size_t count = std::min(elements_per_block<T>(), it.size - it.next_element);
+	const T* elements = self->data() + it.next_element;
+	// the next block, while this one is gathered
+	const std::size_t next_count = std::min(count, it.size - it.next_element - count);
+	const char* next_block = reinterpret_cast<const char*>(elements + count);
+	for (std::size_t offset = 0; offset < next_count*sizeof(T); offset += 64){
+	  prefetch(next_block + offset);
+	};
+	char* buffer = stack.get_array_at<char>(it.buffer_offset);
+	gather_elements(elements, count, buffer);
+	it.next_element += count;
+	return MemCompareInfo{
+	  .next_obj = obj,
+	    .continuation_fn = continue_vector_block_mem_compare_info<T,Alloc>,
+	    .obj  = static_cast<const void*>(buffer),
+	    .size = count*flat_size<T>()
+	    };
+      };
+
       template <class T, class Alloc>
 	typename std::enable_if<!concepts::is_trivial<T>::value
+				and not concepts::is_flat<T>::value
 				,MemCompareInfo>::type
 	continue_vector_mem_compare_info(IteratorStack& stack,
 					 const void* obj){
 	auto self = static_cast< const std::vector<T,Alloc>*>( obj);
-	auto it = stack.get_last<VectorCompareIterator>();
+	auto& it = stack.get_last<VectorCompareIterator>();
 	if ( it.next_element == self->size()  ){
 	  auto it = stack.pop_last<VectorCompareIterator>();
 	  return MemCompareInfo{
@@ -63,6 +263,9 @@ namespace mem_comparable_closure{
 	}else {
 	  std::size_t this_element = it.next_element;
 	  it.next_element = it.next_element+1;
+	  if (this_element + vector_prefetch_distance < it.size){
+	    prefetch(self->data()+this_element+vector_prefetch_distance);
+	  };
 	  return get_mem_compare_info( self->data()+this_element,
 				       obj,
 				       continue_vector_mem_compare_info<T,Alloc>,
@@ -70,20 +273,126 @@ namespace mem_comparable_closure{
 				       );
 	};
       };
+
+      template <class Alloc>
+      MemCompareInfo continue_vector_bool_mem_compare_info(IteratorStack& stack,
+							   const void* obj){
+	auto self = static_cast< const std::vector<bool,Alloc>*>( obj);
+	auto& it = stack.get_last<VectorBoolCompareIterator>();
+	if ( it.next_bit == it.size ){
+	  auto it = stack.pop_last<VectorBoolCompareIterator>();
+	  return MemCompareInfo{
+	    .next_obj = it.next_obj,
+	      .continuation_fn = it.continuation_fn,
+	      .obj  = nullptr,
+	      .size =0
+	      };
+	};
+#ifdef __GLIBCXX__
+	{
+	  using word_t = std::_Bit_type;
+	  constexpr std::size_t word_bits = sizeof(word_t)*CHAR_BIT;
+	  const word_t* words = self->begin()._M_p;
+	  const std::size_t full_words = it.size/word_bits;
+	  if ( it.next_bit == 0 and full_words > 0 ){
+	    it.next_bit = full_words*word_bits;
+	    return MemCompareInfo{
+	      .next_obj = obj,
+		.continuation_fn = continue_vector_bool_mem_compare_info<Alloc>,
+		.obj  = static_cast<const void*>(words),
+		.size = full_words*sizeof(word_t)
+		};
+	  };
+	  if ( it.next_bit == full_words*word_bits and word_bits <= 64){
+	    // the last partial word, masked 
+	    const std::size_t remaining = it.size - it.next_bit;
+	    it.word = words[full_words] & ((word_t(1) << remaining) - 1);
+	    it.next_bit = it.size;
+	    return MemCompareInfo{
+	      .next_obj = obj,
+		.continuation_fn = continue_vector_bool_mem_compare_info<Alloc>,
+		.obj  = static_cast<const void*>(&(it.word)),
+		.size = sizeof(it.word)
+		};
+	  };
+	}
+#endif
+	const std::size_t n_bits = std::min<std::size_t>(64, it.size - it.next_bit);
+	std::uint64_t word = 0;
+	for (std::size_t i = 0; i< n_bits; ++i){
+	  if ((*self)[it.next_bit+i]) word |= std::uint64_t(1) << i;
+	};
+	it.word = word;
+	it.next_bit += n_bits;
+	return MemCompareInfo{
+	  .next_obj = obj,
+	    .continuation_fn = continue_vector_bool_mem_compare_info<Alloc>,
+	    .obj  = static_cast<const void*>(&(it.word)),
+	    .size = sizeof(it.word)
+	    };
+      };
     }
     
-    template<class T, class Alloc>
-    MemCompareInfo get_mem_compare_info(const std::vector<T, Alloc>* vec,
+    template<class Alloc>
+    MemCompareInfo get_mem_compare_info(const std::vector<bool, Alloc>* vec,
 					const void* next_obj,
 					mem_compare_continuation_fn_t continuation_fn,
 				        IteratorStack& stack){
+      assert(vec);
+      new (stack.get_new<VectorBoolCompareIterator>()) VectorBoolCompareIterator{
+	.next_obj = next_obj,  
+	  .continuation_fn = continuation_fn,
+	  .next_bit=0,
+	  .size=vec->size(),
+	  .word=0};
+      
+      auto& it = stack.get_last<VectorBoolCompareIterator>();
+      return MemCompareInfo{
+	.next_obj = static_cast<const void*>(vec),
+	  .continuation_fn = continue_vector_bool_mem_compare_info<Alloc>,
+	  .obj  = static_cast<const void*>(&(it.size)),
+	  .size =sizeof(std::size_t)
+	  };
+    };
+    
+    template<class T, class Alloc>
+    typename std::enable_if<concepts::is_flat<T>::value, MemCompareInfo>::type
+    get_mem_compare_info(const std::vector<T, Alloc>* vec,
+			 const void* next_obj,
+			 mem_compare_continuation_fn_t continuation_fn,
+			 IteratorStack& stack){
+      assert(vec);
+      const std::size_t buffer_size = std::min(elements_per_block<T>(), vec->size())*flat_size<T>();
+      const std::size_t buffer_offset = stack.get_new_array<char>(buffer_size);
+      new (stack.get_new<VectorBlockCompareIterator>()) VectorBlockCompareIterator{
+	.next_obj = next_obj,  
+	  .continuation_fn = continuation_fn,
+	  .next_element=0,
+	  .size=vec->size(),
+	  .buffer_offset=buffer_offset,
+	  .buffer_size=buffer_size};
+      auto& it = stack.get_last<VectorBlockCompareIterator>();
+      return MemCompareInfo{
+	.next_obj = static_cast<const void*>(vec),
+	  .continuation_fn = continue_vector_block_mem_compare_info<T,Alloc>,
+	  .obj  = static_cast<const void*>(&(it.size)),
+	  .size =sizeof(std::size_t)
+	  };
+    };
+
+    template<class T, class Alloc>
+    typename std::enable_if<not concepts::is_flat<T>::value, MemCompareInfo>::type
+    get_mem_compare_info(const std::vector<T, Alloc>* vec,
+			 const void* next_obj,
+			 mem_compare_continuation_fn_t continuation_fn,
+			 IteratorStack& stack){
       new (stack.get_new<VectorCompareIterator>()) VectorCompareIterator{
 	.next_obj = next_obj,  
 	  .continuation_fn = continuation_fn,
 	  .next_element=0,
 	  .size=vec->size()};
       
-      auto it = stack.get_last<VectorCompareIterator>();
+      auto& it = stack.get_last<VectorCompareIterator>();
       assert(vec);
       return MemCompareInfo{
 	.next_obj = static_cast<const void*>(vec),
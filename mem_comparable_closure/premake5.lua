@@ -1,7 +1,7 @@
 GOOGLE_BENCHMARK_LIBDIRS = {}
 
 workspace "mem_comparable_closure"
-    configurations { "Test"}
+    configurations { "Test", "Bench"}
     targetdir "bin"
 
 
@@ -14,8 +14,15 @@ project "mem_comparable_closure"
     includedirs {"include", "src/include"}
     removefiles { "libs/allocators/*.t.cpp"}
     buildoptions { "-Wall",  "-Wno-unused-local-typedef"}
+    links { "pthread" }
     optimize "Debug"
     filter "Test"
         files {"test/*.cpp"}
 	includedirs "libs/doctest/doctest"
 	targetdir "bin/Test"
+    filter "Bench"
+        files {"bench/*.cpp"}
+	libdirs (GOOGLE_BENCHMARK_LIBDIRS)
+	links { "benchmark" }
+	optimize "Speed"
+	targetdir "bin/Bench"
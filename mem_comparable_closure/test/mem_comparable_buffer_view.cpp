@@ -0,0 +1,106 @@
+#include "doctest.h"
+#include "mem_comparable_buffer_view.hpp"
+#include "mem_comparable_vector.hpp"
+
+namespace {
+  struct MyCountedElement{
+    static int accesses;
+    int value = 0;
+    std::tuple<const int*> get_member_access()const{
+      ++accesses;
+      return std::tuple<const int*>(&(this->value));
+    };
+  };
+  int MyCountedElement::accesses = 0;
+
+  int sum(mem_comparable_closure::BufferView<int> values, int offset){
+    int result = offset;
+    for (int value : values) result += value;
+    return result;
+  };
+
+  int count(mem_comparable_closure::BufferView<MyCountedElement> elements, int offset){
+    return static_cast<int>(elements.get_size()) + offset;
+  };
+
+  template<class C, class = void>
+  struct has_buffer_view : std::false_type{};
+
+  template<class C>
+  struct has_buffer_view<C, std::void_t<decltype(mem_comparable_closure::make_buffer_view(std::declval<C>()))>>
+    : std::true_type{};
+}
+
+template<>
+struct ::mem_comparable_closure::concepts::is_member_accessible<MyCountedElement> : std::true_type{};
+
+TEST_CASE("BufferView"){
+  using namespace mem_comparable_closure;
+  using view_t = BufferView<int>;
+
+  CHECK(concepts::is_transparent<view_t>::value);
+  CHECK_FALSE(concepts::is_trivial<view_t>::value);
+
+  const std::vector<int> buffer{1,2,3,4};
+  const std::vector<int> equal_buffer{1,2,3,4};
+  const std::vector<int> other_buffer{1,2,3,5};
+
+  SUBCASE("compare"){
+    CHECK(is_identical(make_buffer_view(buffer), make_buffer_view(buffer)));
+    // different buffers are compared by their elements
+    CHECK(is_identical(make_buffer_view(buffer), make_buffer_view(equal_buffer)));
+    CHECK(is_updated(make_buffer_view(buffer), make_buffer_view(other_buffer)));
+    CHECK(is_updated(make_buffer_view(buffer), view_t(buffer.data(), 3)));
+    CHECK(is_identical(view_t(), view_t(buffer.data(), 0)));
+    CHECK(structural_hash(make_buffer_view(buffer)) == structural_hash(make_buffer_view(equal_buffer)));
+  };
+
+  SUBCASE("the same buffer is not read"){
+    const std::vector<MyCountedElement> elements(100);
+    const std::vector<MyCountedElement> equal_elements(100);
+    MyCountedElement::accesses = 0;
+    CHECK(is_identical(make_buffer_view(elements), make_buffer_view(elements)));
+    CHECK(MyCountedElement::accesses == 0);
+    CHECK(is_identical(make_buffer_view(elements), make_buffer_view(equal_elements)));
+    CHECK(MyCountedElement::accesses == 200);
+  };
+
+  SUBCASE("non-trivial elements"){
+    const std::vector<std::vector<int>> nested{{1}, {2,3}};
+    const std::vector<std::vector<int>> equal_nested{{1}, {2,3}};
+    const std::vector<std::vector<int>> other_nested{{1}, {2,4}};
+    CHECK(is_identical(make_buffer_view(nested), make_buffer_view(equal_nested)));
+    CHECK(is_updated(make_buffer_view(nested), make_buffer_view(other_nested)));
+  };
+
+  SUBCASE("fingerprint"){
+    const std::vector<MyCountedElement> elements(100);
+    MyCountedElement::accesses = 0;
+    auto view = make_buffer_view(elements);
+    CHECK(MyCountedElement::accesses == 0);
+    CHECK(view.get_fingerprint() == structural_hash(view));
+    MyCountedElement::accesses = 0;
+    // copies keep the fingerprint, so binding them doesn't read the buffer
+    auto closure1 = closure_from_fp(count).bind(view).as_fun();
+    auto closure2 = closure_from_fp(count).bind(view).as_fun();
+    CHECK(MyCountedElement::accesses == 0);
+    CHECK(closure1.get_fingerprint() == closure2.get_fingerprint());
+    CHECK(make_buffer_view(buffer).get_fingerprint() == make_buffer_view(equal_buffer).get_fingerprint());
+    CHECK(make_buffer_view(buffer).get_fingerprint() != make_buffer_view(other_buffer).get_fingerprint());
+  };
+
+  SUBCASE("no views of temporaries"){
+    CHECK(has_buffer_view<const std::vector<int>&>::value);
+    CHECK_FALSE(has_buffer_view<std::vector<int>>::value);
+    CHECK_FALSE(has_buffer_view<const std::vector<int>>::value);
+  };
+
+  SUBCASE("closed over"){
+    auto closure1 = closure_from_fp(sum).bind(make_buffer_view(buffer)).as_fun();
+    auto closure2 = closure_from_fp(sum).bind(make_buffer_view(buffer)).as_fun();
+    auto closure3 = closure_from_fp(sum).bind(make_buffer_view(other_buffer)).as_fun();
+    CHECK(closure1(1) == 11);
+    CHECK(is_identical(closure1, closure2));
+    CHECK(is_updated(closure1, closure3));
+  };
+}
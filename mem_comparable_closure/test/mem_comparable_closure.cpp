@@ -3,6 +3,7 @@
 #include "mem_comparable_closure.hpp"
 #include <type_traits>
 #include <array>
+#include <cstdint>
 
 enum class MyEnum: int{
   a,b,c};
@@ -23,6 +24,64 @@ private:
 template<>
 struct ::mem_comparable_closure::concepts::is_member_accessible<MyMemberAccessibleClass> : std::true_type{};
 
+struct MyCopyCounter{
+  static int copies;
+  int value = 0;
+  MyCopyCounter() = default;
+  MyCopyCounter(const MyCopyCounter& other):value(other.value){ ++copies; };
+  MyCopyCounter(MyCopyCounter&& other) = default;
+  std::tuple<const int*> get_member_access()const{
+    return std::tuple<const int*>(&(this->value));
+  };
+};
+int MyCopyCounter::copies = 0;
+
+template<>
+struct ::mem_comparable_closure::concepts::is_member_accessible<MyCopyCounter> : std::true_type{};
+
+// counts how often its members are walked
+struct MyWalkCounter{
+  static int walks;
+  int value = 0;
+  std::tuple<const int*> get_member_access()const{
+    ++walks;
+    return std::tuple<const int*>(&(this->value));
+  };
+};
+int MyWalkCounter::walks = 0;
+
+template<>
+struct ::mem_comparable_closure::concepts::is_member_accessible<MyWalkCounter> : std::true_type{};
+
+// records the stack address at which it is compared
+struct MyStackProbe{
+  static std::uintptr_t address;
+  int value = 0;
+  mem_comparable_closure::MemCompareInfo get_mem_compare_info(const void* next_obj,
+							      mem_comparable_closure::mem_compare_continuation_fn_t continuation,
+							      mem_comparable_closure::IteratorStack& )const{
+    int local = 0;
+    address = reinterpret_cast<std::uintptr_t>(&local);
+    return mem_comparable_closure::MemCompareInfo{
+      .next_obj = next_obj,
+	.continuation_fn = continuation,
+	.obj  = static_cast<const void*>(&(this->value)),
+	.size = sizeof(int)
+	};
+  };
+};
+std::uintptr_t MyStackProbe::address = 0;
+
+template<>
+struct ::mem_comparable_closure::concepts::is_protocol_compatible<MyStackProbe> : std::true_type{};
+
+enum class MyAction: int{
+  walk, jump};
+
+constexpr int perform(MyAction action, int id, int times){
+  return (action == MyAction::jump ? 1000 : 0) + id*times;
+}
+
 TEST_CASE("concepts"){
   using  mem_comparable_closure::concepts::is_transparent;
   
@@ -30,16 +89,62 @@ TEST_CASE("concepts"){
   CHECK_FALSE(is_transparent< MyIntransparentStruct>::value);
 
   SUBCASE("is_trivial"){
-    enum class MyIntransparentEnum: int{
+    enum class MyUnregisteredEnum: int{
       a,b,c};
-    CHECK_FALSE(is_transparent< MyIntransparentEnum>::value);
+    CHECK(is_transparent< MyUnregisteredEnum>::value);
     CHECK(is_transparent< MyEnum>::value);
   };
 
+  SUBCASE("automatically trivial"){
+    using  mem_comparable_closure::concepts::is_trivial;
+    struct MyPaddingFreeStruct{ int a; unsigned int b; };
+    struct MyPaddedStruct{ char a; int b; };
+    struct MyFloatStruct{ float a; };
+    CHECK(is_trivial< MyPaddingFreeStruct>::value);
+    CHECK_FALSE(is_trivial< MyPaddedStruct>::value);
+    CHECK(mem_comparable_closure::is_identical(MyPaddingFreeStruct{1,2}, MyPaddingFreeStruct{1,2}));
+    CHECK(mem_comparable_closure::is_updated(MyPaddingFreeStruct{1,2}, MyPaddingFreeStruct{1,3}));
+    CHECK_FALSE(is_trivial< int*>::value);
+    // also not in fields
+    struct MyPointerStruct{ int* a; };
+    struct MyNestedPointerStruct{ int a; MyPointerStruct b; };
+    struct MyPointerArrayStruct{ int a; int* b[2]; };
+    struct MyArrayStruct{ int a[3]; unsigned int b; };
+    CHECK_FALSE(is_trivial< MyPointerStruct>::value);
+    CHECK_FALSE(is_trivial< MyNestedPointerStruct>::value);
+    CHECK_FALSE(is_trivial< MyPointerArrayStruct>::value);
+    CHECK_FALSE(is_trivial< int*[2]>::value);
+    CHECK(is_trivial< MyArrayStruct>::value);
+    // floats only by their policy
+    CHECK(is_trivial< double>::value);
+    CHECK_FALSE(is_trivial< MyFloatStruct>::value);
+    // explicitly registered stays registered
+    CHECK_FALSE(is_trivial< MyMemberAccessibleClass>::value);
+  };
+
   SUBCASE("is_member_accessible"){
     
     CHECK(is_transparent< MyMemberAccessibleClass>::value);
   }
+
+  SUBCASE("is_aggregate_reflectable"){
+    using  mem_comparable_closure::concepts::is_aggregate_reflectable;
+    // padded, so not trivial
+    struct MyAggregate{ char a; int b; };
+    struct MyArrayAggregate{ char a; int b[3]; };
+    struct MySingleArrayAggregate{ char a; int b[1]; };
+    struct MyDerivedAggregate: MyAggregate{ int c; };
+    struct MyEmptyBase{};
+    struct MyEmptyDerivedAggregate: MyEmptyBase{ char a; int b; };
+    CHECK(is_aggregate_reflectable< MyAggregate>::value);
+    // rejected without binding their fields
+    CHECK_FALSE(is_aggregate_reflectable< MyArrayAggregate>::value);
+    CHECK_FALSE(is_aggregate_reflectable< MySingleArrayAggregate>::value);
+    CHECK_FALSE(is_aggregate_reflectable< MyDerivedAggregate>::value);
+    CHECK_FALSE(is_aggregate_reflectable< MyEmptyDerivedAggregate>::value);
+    CHECK_FALSE(is_transparent< MyArrayAggregate>::value);
+    CHECK_FALSE(is_transparent< MyDerivedAggregate>::value);
+  }
 };
 
 
@@ -114,6 +219,20 @@ TEST_CASE("Closure"){
     CHECK(new_closure(3) == 2);
 
   };
+  SUBCASE("invocation copies"){
+    int (*fn)(MyCopyCounter, MyCopyCounter, MyCopyCounter) = [](MyCopyCounter a, MyCopyCounter b, MyCopyCounter c){
+      return a.value+b.value+c.value;
+    };
+    auto closure = closure_from_fp(fn).bind(MyCopyCounter{}).bind(MyCopyCounter{});
+    auto fun = closure.as_fun();
+    MyCopyCounter::copies = 0;
+    closure(MyCopyCounter{});
+    // the bound values are only copied into the parameters of fn
+    CHECK(MyCopyCounter::copies == 2);
+    MyCopyCounter::copies = 0;
+    fun(MyCopyCounter{});
+    CHECK(MyCopyCounter::copies == 2);
+  };
   SUBCASE("Metaprogramming Errors"){ 
     // we would need to check that this gives an compiler error
     // test::check_transparency<int&> h{};
@@ -154,6 +273,7 @@ TEST_CASE("Closure"){
 	};
 	info = info.continuation_fn(stack, info.next_obj );
       };
+      // the two bound values (a single chunk) and the function pointer
       CHECK(counter ==3);
       
     };
@@ -164,8 +284,146 @@ TEST_CASE("Closure"){
     
     CHECK_FALSE(is_identical(closure2,closure3));
     CHECK(is_updated( closure2,closure3) );
+    // same bound value, different function
+    int (*other_fn)(int,int) = [](int a, int b ) -> int { return b;};
+    CHECK(is_updated( closure1, ClosureMaker<int,int,int>::make(other_fn).bind(2).as_fun()) );
     //    REQUIRE(mem_info2.size==mem_info3.size );
     //    CHECK(std::memcmp(mem_info2.obj, mem_info3.obj, mem_info2.size) != 0);
   };
 
+  SUBCASE("Function"){
+    int (*fn)(int,int) = [](int a, int b ) -> int { return a+b;};
+    auto closure = ClosureMaker<int,int,int>::make(fn).bind(2);
+    auto fun = closure.as_fun();
+    auto copy = fun.copy();
+    CHECK(copy(1) == 3);
+    CHECK(is_identical(fun, copy));
+
+    auto other = ClosureMaker<int,int,int>::make(fn).bind(5).as_fun();
+    other = std::move(copy);
+    CHECK(other(1) == 3);
+    CHECK_THROWS_AS(copy(1), std::bad_function_call);
+
+    // a Function over a ClosureBase
+    using holder_t = ClosureHolder<FunctionSignature<int,int>, int>;
+    Function<int,int> from_base(std::make_shared<holder_t>(ClosureContainer<FunctionSignature<int,int,int>>(fn).bind(2)));
+    CHECK(from_base(1) == 3);
+    CHECK(is_identical(fun, from_base));
+    CHECK(fun.get_fingerprint() == from_base.get_fingerprint());
+  };
+
+  SUBCASE("layout"){
+    int (*fn)(bool, double, int, bool) = [](bool a, double b, int c, bool d ) -> int {
+      return (a ? 1 : 0) + static_cast<int>(b) + c + (d ? 1 : 0);};
+    auto closure = ClosureMaker<int, bool, double, int, bool>::make(fn).bind(true).bind(2.0).bind(3);
+    using closure_t = decltype(closure);
+    // packed as double, int, bool
+    static_assert(closure_t::layout.value_size == 13, "");
+    static_assert(closure_t::layout.storage_size == 16, "");
+    static_assert(closure_t::layout.bind_order_size == 24, "");
+    static_assert(closure_t::layout.segment_count == 1, "");
+    CHECK(closure(true) == 7);
+    CHECK(closure.bind(false)() == 6);
+
+    auto same = ClosureMaker<int, bool, double, int, bool>::make(fn).bind(true).bind(2.0).bind(3);
+    CHECK(is_identical(closure.as_fun(), same.as_fun()));
+    CHECK(is_updated(closure.as_fun(), ClosureMaker<int, bool, double, int, bool>::make(fn).bind(false).bind(2.0).bind(3).as_fun()));
+    CHECK(is_updated(closure.as_fun(), ClosureMaker<int, bool, double, int, bool>::make(fn).bind(true).bind(2.0).bind(4).as_fun()));
+  };
+
+  SUBCASE("fingerprint"){
+    int (*fn)(int,int) = [](int a, int b ) -> int { return a+b;};
+    int (*other_fn)(int,int) = [](int a, int b ) -> int { return a-b;};
+    auto prefix = ClosureMaker<int,int,int>::make(fn).bind(2);
+    auto closure1 = prefix.bind(3);
+    auto closure2 = ClosureMaker<int,int,int>::make(fn).bind(2).bind(3);
+    CHECK(closure1.get_fingerprint() == closure2.get_fingerprint());
+    CHECK(closure1.get_fingerprint() != prefix.bind(4).get_fingerprint());
+    CHECK(closure1.get_fingerprint() != ClosureMaker<int,int,int>::make(other_fn).bind(2).bind(3).get_fingerprint());
+    // binding does not change the fingerprint of the prefix
+    CHECK(prefix.get_fingerprint() == ClosureMaker<int,int,int>::make(fn).bind(2).get_fingerprint());
+
+    auto fun = closure1.as_fun();
+    CHECK(fun.get_fingerprint() == closure1.get_fingerprint());
+    CHECK(fun.copy().get_fingerprint() == closure1.get_fingerprint());
+    CHECK(fingerprint_of(fun) == closure1.get_fingerprint());
+    CHECK(fingerprint_of(5) == structural_hash(5));
+  };
+
+  SUBCASE("fingerprint of a bound Function"){
+    int (*inner_fn)(MyWalkCounter, int) = [](MyWalkCounter counter, int x) -> int { return counter.value + x;};
+    int (*outer_fn)(Function<int,int>, int) = [](Function<int,int> inner, int x) -> int { return inner(x);};
+    auto make_outer = [&](int value){
+      auto inner = closure_from_fp(inner_fn).bind(MyWalkCounter{value}).as_fun();
+      MyWalkCounter::walks = 0;
+      auto outer = closure_from_fp(outer_fn).bind(std::move(inner));
+      // the inner Function contributes its cached fingerprint
+      CHECK(MyWalkCounter::walks == 0);
+      return outer;
+    };
+    CHECK(make_outer(1).get_fingerprint() == make_outer(1).get_fingerprint());
+    CHECK(make_outer(1).get_fingerprint() != make_outer(2).get_fingerprint());
+  };
+
+  SUBCASE("nested Functions"){
+    int (*probe_fn)(MyStackProbe, int) = [](MyStackProbe probe, int x) -> int { return probe.value + x;};
+    int (*wrap_fn)(Function<int,int>, int) = [](Function<int,int> inner, int x) -> int { return inner(x) + 1;};
+    auto make_chain = [&](std::size_t depth){
+      auto fun = closure_from_fp(probe_fn).bind(MyStackProbe{}).as_fun();
+      for (std::size_t i = 0; i< depth; ++i){
+	fun = closure_from_fp(wrap_fn).bind(std::move(fun)).as_fun();
+      };
+      return fun;
+    };
+    auto probe_address = [&](std::size_t depth){
+      auto fun1 = make_chain(depth);
+      auto fun2 = make_chain(depth);
+      CHECK(fun1(0) == static_cast<int>(depth));
+      CHECK(fun1.get_fingerprint() == fun2.get_fingerprint());
+      MyStackProbe::address = 0;
+      CHECK(is_identical(fun1, fun2));
+      return MyStackProbe::address;
+    };
+    // the innermost value is reached from the same frame at any depth
+    const std::uintptr_t shallow = probe_address(1);
+    const std::uintptr_t deep = probe_address(2000);
+    CHECK(shallow != 0);
+    CHECK((shallow > deep ? shallow - deep : deep - shallow) < 1024);
+    CHECK(is_updated(make_chain(100), make_chain(101)));
+  };
+
+}
+
+template<class T, class = void>
+struct has_as_view : std::false_type{};
+
+template<class T>
+struct has_as_view<T, std::void_t<decltype(std::declval<T>().as_view())>> : std::true_type{};
+
+TEST_CASE("constant closures"){
+  using namespace mem_comparable_closure;
+
+  static constexpr auto jump = closure_from_fp(perform).bind(MyAction::jump).bind(7);
+  static_assert(jump(2) == 1014, "");
+  // no allocation, no reference count
+  static constexpr FunctionView<int, int> jump_view = jump.as_view();
+  CHECK(jump_view(3) == 1021);
+
+  auto runtime_jump = closure_from_fp(perform).bind(MyAction::jump).bind(7);
+  auto runtime_walk = closure_from_fp(perform).bind(MyAction::walk).bind(7);
+  CHECK(is_identical(jump_view, runtime_jump.as_view()));
+  CHECK(is_updated(jump_view, runtime_walk.as_view()));
+  // only a Closure that outlives the view can be viewed
+  using jump_t = decltype(runtime_jump);
+  static_assert(has_as_view<const jump_t&>::value, "");
+  static_assert(not has_as_view<jump_t>::value, "");
+  using nullary_t = decltype(runtime_jump.bind(2));
+  static_assert(has_as_view<nullary_t&>::value, "");
+  static_assert(not has_as_view<nullary_t&&>::value, "");
+  static_assert(not has_as_view<const nullary_t&&>::value, "");
+  // the fingerprint of a constant closure is computed on demand
+  CHECK(jump.get_fingerprint() == runtime_jump.get_fingerprint());
+  CHECK(jump_view.get_fingerprint() == runtime_jump.get_fingerprint());
+  CHECK(jump.bind(2).get_fingerprint() == runtime_jump.bind(2).get_fingerprint());
+  CHECK(is_identical(jump.bind(2).as_fun(), runtime_jump.bind(2).as_fun()));
 }
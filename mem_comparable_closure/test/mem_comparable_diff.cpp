@@ -0,0 +1,66 @@
+#include "doctest.h"
+#include "mem_comparable_diff.hpp"
+
+namespace {
+  int row(int id, int value){
+    return id*value;
+  };
+
+  mem_comparable_closure::Function<int, int> make_row(int id){
+    return mem_comparable_closure::closure_from_fp(row).bind(id).as_fun();
+  };
+}
+
+TEST_CASE("diff"){
+  using namespace mem_comparable_closure;
+  using function_t = Function<int, int>;
+
+  std::vector<function_t> old_vec;
+  for (int id = 0; id< 5; ++id) old_vec.push_back(make_row(id));
+
+  SUBCASE("identical"){
+    std::vector<function_t> new_vec;
+    for (int id = 0; id< 5; ++id) new_vec.push_back(make_row(id));
+    CHECK(diff(old_vec, new_vec).empty());
+  };
+
+  SUBCASE("insert"){
+    std::vector<function_t> new_vec;
+    for (int id = 0; id< 5; ++id){
+      if (id == 2) new_vec.push_back(make_row(10));
+      new_vec.push_back(make_row(id));
+    };
+    auto edits = diff(old_vec, new_vec);
+    REQUIRE(edits.size() == 1);
+    CHECK(edits[0] == Edit{EditKind::insert, Edit::no_index, 2});
+  };
+
+  SUBCASE("remove and update"){
+    std::vector<function_t> new_vec;
+    new_vec.push_back(make_row(0));
+    new_vec.push_back(make_row(11));
+    new_vec.push_back(make_row(3));
+    new_vec.push_back(make_row(4));
+    auto edits = diff(old_vec, new_vec);
+    REQUIRE(edits.size() == 2);
+    CHECK(edits[0] == Edit{EditKind::remove, 2, Edit::no_index});
+    CHECK(edits[1] == Edit{EditKind::update, 1, 1});
+  };
+
+  SUBCASE("move"){
+    std::vector<function_t> new_vec;
+    new_vec.push_back(make_row(4));
+    for (int id = 0; id< 4; ++id) new_vec.push_back(make_row(id));
+    auto edits = diff(old_vec, new_vec);
+    REQUIRE(edits.size() == 1);
+    CHECK(edits[0] == Edit{EditKind::move, 4, 0});
+  };
+
+  SUBCASE("duplicates"){
+    std::vector<int> old_ints{1, 1, 2};
+    std::vector<int> new_ints{2, 1, 1};
+    auto edits = diff(old_ints, new_ints);
+    REQUIRE(edits.size() == 1);
+    CHECK(edits[0] == Edit{EditKind::move, 2, 0});
+  };
+}
@@ -0,0 +1,48 @@
+#include "doctest.h"
+#include "mem_comparable_fuzz.hpp"
+
+namespace {
+  mem_comparable_closure::ComparisonState compare_in_steps(const fuzz::function_t& fun1,
+							   const fuzz::function_t& fun2,
+							   std::mt19937_64& rng){
+    using namespace mem_comparable_closure;
+    Comparator<fuzz::function_t> comparator(fun1, fun2);
+    while (comparator.step(1 + rng() % 64) == ComparisonState::more_work){};
+    return comparator.get_state();
+  };
+}
+
+TEST_CASE("differential fuzzing"){
+  using namespace mem_comparable_closure;
+  constexpr std::size_t iterations = 500;
+  std::mt19937_64 rng(20261018);
+  std::size_t identical_count = 0;
+
+  for (std::size_t i = 0; i< iterations; ++i){
+    const std::uint64_t seed = rng();
+    fuzz::Generator generator1(seed);
+    auto [fun1, shape1] = generator1.generate();
+    // a quarter of the pairs are generated without a mutation
+    const std::size_t mutate_at = rng() % 4 == 0 ?
+      fuzz::Generator::no_mutation : rng() % generator1.get_draw_count();
+    fuzz::Generator generator2(seed, mutate_at);
+    auto [fun2, shape2] = generator2.generate();
+
+    CAPTURE(seed);
+    CAPTURE(mutate_at);
+    const bool expected = shape1 == shape2;
+    identical_count += expected;
+    CHECK(is_identical(fun1, fun2) == expected);
+    CHECK(is_identical(fun2, fun1) == expected);
+    CHECK(is_identical(fun1, fun1.copy()));
+    CHECK((compare_in_steps(fun1, fun2, rng) == ComparisonState::identical) == expected);
+    if (expected){
+      CHECK(structural_hash(fun1) == structural_hash(fun2));
+      CHECK(fun1.get_fingerprint() == fun2.get_fingerprint());
+      CHECK(fun1(3) == fun2(3));
+    };
+  };
+  // both outcomes have to be covered
+  CHECK(identical_count > iterations/8);
+  CHECK(identical_count < iterations/2);
+}
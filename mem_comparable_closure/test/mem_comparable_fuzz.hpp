@@ -0,0 +1,170 @@
+#ifndef MEM_COMPARABLE_FUZZ_HPP
+#define MEM_COMPARABLE_FUZZ_HPP
+
+#include "mem_comparable_closure.hpp"
+#include "mem_comparable_vector.hpp"
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// random closure shapes for the differential test (test/mem_comparable_fuzz.cpp)
+// and the throughput benchmark (bench/fuzz.cpp).
+//   every generated Function comes with a Shape, a plain tree of everything that was drawn.
+//   two Functions have to be identical exactly if their Shapes are equal.
+namespace fuzz{
+  using function_t = mem_comparable_closure::Function<int, int>;
+
+  // member accessible
+  struct Record{
+    int id = 0;
+    short flags = 0;
+    std::vector<int> items;
+    std::tuple<const int*, const short*, const std::vector<int>*> get_member_access()const{
+      return std::tuple<const int*, const short*, const std::vector<int>*>(
+	  &(this->id), &(this->flags), &(this->items));
+    };
+  };
+
+  // a reflected aggregate with padding (compared in blocks inside a vector)
+  struct Sample{
+    char tag;
+    int value;
+  };
+}
+
+namespace mem_comparable_closure{
+  template<>
+  struct concepts::is_member_accessible<fuzz::Record> : std::true_type{};
+}
+
+namespace fuzz{
+  enum class Kind: int{
+    trivials, int_vector, record, samples, nested, function_list, count};
+
+  // the oracle: compared member by member
+  struct Shape{
+    Kind kind;
+    std::vector<std::int64_t> values;
+    std::vector<Shape> children;
+  };
+
+  inline bool operator==(const Shape& shape1, const Shape& shape2){
+    if (shape1.kind != shape2.kind) return false;
+    if (shape1.values != shape2.values) return false;
+    if (shape1.children.size() != shape2.children.size()) return false;
+    for (std::size_t i = 0; i< shape1.children.size(); ++i){
+      if (not (shape1.children[i] == shape2.children[i])) return false;
+    };
+    return true;
+  };
+
+  inline int trivials_a(int a, char b, int x){ return a + b + x;};
+  inline int trivials_b(int a, char b, int x){ return a - b + x;};
+  inline int sum_ints(std::vector<int> values, int x){
+    for (int value : values) x += value;
+    return x;
+  };
+  inline int sum_record(Record record, int x){ return record.id + record.flags + sum_ints(record.items, x);};
+  inline int sum_samples(std::vector<Sample> samples, int x){
+    for (const Sample& sample : samples) x += sample.tag + sample.value;
+    return x;
+  };
+  inline int call_nested(function_t fun, int k, int x){ return fun(x) + k;};
+  inline int call_all(std::vector<function_t> funs, int x){
+    for (const auto& fun : funs) x += fun(x);
+    return x;
+  };
+
+  class Generator{
+  public:
+    static constexpr std::size_t no_mutation = static_cast<std::size_t>(-1);
+    static constexpr int max_depth = 3;
+
+    // the draw at mutate_at is replaced by another value,
+    //   all other draws are the same as without the mutation.
+    explicit Generator(std::uint64_t seed, std::size_t mutate_at = no_mutation):
+      rng(seed), mutate_at(mutate_at){};
+
+    // first_kind forces the kind of the outermost closure
+    std::pair<function_t, Shape> generate(int depth = max_depth, Kind first_kind = Kind::count){
+      Shape shape{};
+      const std::int64_t kind_count = static_cast<std::int64_t>(depth > 0 ? Kind::count : Kind::nested);
+      const std::int64_t drawn_kind = this->draw(kind_count);
+      shape.kind = first_kind == Kind::count ? static_cast<Kind>(drawn_kind) : first_kind;
+      switch (shape.kind){
+      case Kind::trivials:{
+	const int a = static_cast<int>(this->draw(1000, shape));
+	const char b = static_cast<char>(this->draw(3, shape));
+	auto fn = this->draw(2, shape) == 0 ? trivials_a : trivials_b;
+	return {mem_comparable_closure::closure_from_fp(fn).bind(a).bind(b).as_fun(), shape};
+      }
+      case Kind::int_vector:{
+	return {mem_comparable_closure::closure_from_fp(sum_ints).bind(this->draw_ints(shape)).as_fun(), shape};
+      }
+      case Kind::record:{
+	Record record{};
+	record.id = static_cast<int>(this->draw(100, shape));
+	record.flags = static_cast<short>(this->draw(4, shape));
+	record.items = this->draw_ints(shape);
+	return {mem_comparable_closure::closure_from_fp(sum_record).bind(std::move(record)).as_fun(), shape};
+      }
+      case Kind::samples:{
+	// crosses the block size of vector comparisons
+	std::vector<Sample> samples(static_cast<std::size_t>(this->draw(2000, shape)));
+	for (auto& sample : samples){
+	  sample.tag = static_cast<char>(this->draw(2, shape));
+	  sample.value = static_cast<int>(this->draw(3, shape));
+	};
+	return {mem_comparable_closure::closure_from_fp(sum_samples).bind(std::move(samples)).as_fun(), shape};
+      }
+      case Kind::nested:{
+	auto child = this->generate(depth-1);
+	shape.children.push_back(std::move(child.second));
+	const int k = static_cast<int>(this->draw(10, shape));
+	return {mem_comparable_closure::closure_from_fp(call_nested).bind(std::move(child.first)).bind(k).as_fun(), shape};
+      }
+      case Kind::function_list:
+      default:{
+	const std::size_t size = static_cast<std::size_t>(this->draw(4, shape));
+	std::vector<function_t> funs;
+	for (std::size_t i = 0; i< size; ++i){
+	  auto child = this->generate(depth-1);
+	  shape.children.push_back(std::move(child.second));
+	  funs.push_back(std::move(child.first));
+	};
+	return {mem_comparable_closure::closure_from_fp(call_all).bind(std::move(funs)).as_fun(), shape};
+      }
+      };
+    };
+
+    std::size_t get_draw_count()const{return this->draw_count;};
+
+  private:
+    // a value in [0, n)
+    std::int64_t draw(std::int64_t n){
+      std::int64_t value = static_cast<std::int64_t>(this->rng() % static_cast<std::uint64_t>(n));
+      if (this->draw_count == this->mutate_at and n > 1) value = (value + 1) % n;
+      ++(this->draw_count);
+      return value;
+    };
+
+    std::int64_t draw(std::int64_t n, Shape& shape){
+      shape.values.push_back(this->draw(n));
+      return shape.values.back();
+    };
+
+    std::vector<int> draw_ints(Shape& shape){
+      std::vector<int> values(static_cast<std::size_t>(this->draw(40, shape)));
+      for (auto& value : values) value = static_cast<int>(this->draw(5, shape));
+      return values;
+    };
+
+    std::mt19937_64 rng;
+    std::size_t mutate_at;
+    std::size_t draw_count = 0;
+  };
+}
+
+#endif //MEM_COMPARABLE_FUZZ_HPP
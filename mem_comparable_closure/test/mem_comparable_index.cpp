@@ -0,0 +1,115 @@
+#include "doctest.h"
+#include "mem_comparable_index.hpp"
+#include "mem_comparable_vector.hpp"
+
+namespace {
+  int scale(std::vector<int> values, int factor, int i){
+    return values[i]*factor;
+  };
+
+  int first(std::vector<int> values, int i){
+    return values[i];
+  };
+
+  using scale_container_t = mem_comparable_closure::ClosureContainer<
+    mem_comparable_closure::FunctionSignature<int, int>, int, std::vector<int>>;
+
+  // a hand written ClosureBase, compared like the container it forwards to
+  struct MyScaleClosure: mem_comparable_closure::ClosureBase<int, int>{
+    explicit MyScaleClosure(scale_container_t container):container(std::move(container)){};
+
+    int operator()(int i)const override{
+      return this->container(i);
+    };
+
+    mem_comparable_closure::MemCompareInfo get_mem_compare_info(const void* next_obj,
+								mem_comparable_closure::mem_compare_continuation_fn_t continuation,
+								mem_comparable_closure::IteratorStack& stack)const override{
+      return this->container.get_mem_compare_info(next_obj, continuation, stack);
+    };
+
+    std::size_t get_fingerprint()const override{
+      return this->container.get_fingerprint();
+    };
+
+    scale_container_t container;
+  };
+}
+
+TEST_CASE("FunctionIndex"){
+  using namespace mem_comparable_closure;
+  using function_t = Function<int, int>;
+
+  auto make_scale = [](std::vector<int> values, int factor){
+    return closure_from_fp(scale).bind(std::move(values)).bind(factor).as_fun();
+  };
+
+  FunctionIndex<int, int> index;
+  for (int factor = 0; factor < 100; ++factor){
+    CHECK(index.insert(make_scale({1,2,3}, factor)).second);
+  };
+  CHECK(index.get_size() == 100);
+
+  SUBCASE("find"){
+    auto found = index.find(make_scale({1,2,3}, 42));
+    REQUIRE(found);
+    CHECK((*found)(1) == 84);
+    CHECK_FALSE(index.find(make_scale({1,2,3}, 100)));
+    CHECK_FALSE(index.find(make_scale({1,2,4}, 42)));
+    // another type with the same values
+    CHECK_FALSE(index.find(closure_from_fp(first).bind(std::vector<int>{1,2,3}).as_fun()));
+    CHECK_FALSE(index.find(function_t(nullptr)));
+  };
+
+  SUBCASE("insert"){
+    auto result = index.insert(make_scale({1,2,3}, 7));
+    CHECK_FALSE(result.second);
+    CHECK((*result.first)(2) == 21);
+    CHECK(index.get_size() == 100);
+  };
+
+  SUBCASE("erase"){
+    CHECK(index.erase(make_scale({1,2,3}, 7)));
+    CHECK_FALSE(index.erase(make_scale({1,2,3}, 7)));
+    CHECK_FALSE(index.find(make_scale({1,2,3}, 7)));
+    CHECK(index.get_size() == 99);
+  };
+
+  SUBCASE("empty Functions"){
+    auto result = index.insert(function_t(nullptr));
+    CHECK(result.second);
+    // the second one is found, not compared
+    CHECK_FALSE(index.insert(function_t(nullptr)).second);
+    CHECK(index.find(function_t(nullptr)) == result.first);
+    // a moved from Function is empty as well
+    auto moved = make_scale({1,2,3}, 7);
+    auto target = std::move(moved);
+    CHECK(index.find(moved) == result.first);
+    CHECK(index.get_size() == 101);
+    CHECK(index.erase(function_t(nullptr)));
+    CHECK_FALSE(index.find(function_t(nullptr)));
+    CHECK(index.get_size() == 100);
+  };
+
+  SUBCASE("over a ClosureBase"){
+    using holder_t = ClosureHolder<FunctionSignature<int,int>, int, std::vector<int>>;
+    auto container = ClosureContainer<FunctionSignature<int, std::vector<int>, int, int>>(scale)
+      .bind(std::vector<int>{1,2,3}).bind(5);
+    function_t from_base(std::make_shared<holder_t>(container));
+    CHECK(from_base.get_type_id() != make_scale({1,2,3}, 5).get_type_id());
+    auto found = index.find(from_base);
+    REQUIRE(found);
+    CHECK((*found)(0) == 5);
+  };
+
+  SUBCASE("over a custom ClosureBase"){
+    auto container = ClosureContainer<FunctionSignature<int, std::vector<int>, int, int>>(scale)
+      .bind(std::vector<int>{1,2,3}).bind(5);
+    function_t from_custom(std::make_shared<MyScaleClosure>(container));
+    CHECK(from_custom.get_fingerprint() == make_scale({1,2,3}, 5).get_fingerprint());
+    CHECK(is_identical(from_custom, make_scale({1,2,3}, 5)));
+    auto found = index.find(from_custom);
+    REQUIRE(found);
+    CHECK((*found)(1) == 10);
+  };
+}
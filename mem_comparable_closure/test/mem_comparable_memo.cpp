@@ -0,0 +1,68 @@
+#include "doctest.h"
+#include "mem_comparable_memo.hpp"
+
+namespace {
+  int call_counter = 0;
+
+  int add(int a, int b){
+    ++call_counter;
+    return a+b;
+  };
+}
+
+TEST_CASE("structural_hash"){
+  using namespace mem_comparable_closure;
+
+  auto closure1 = closure_from_fp(add).bind(2).as_fun();
+  auto closure2 = closure_from_fp(add).bind(2).as_fun();
+  auto closure3 = closure_from_fp(add).bind(3).as_fun();
+  CHECK(structural_hash(closure1) == structural_hash(closure2));
+  CHECK(structural_hash(closure1) != structural_hash(closure3));
+  CHECK(structural_hash(5) == structural_hash(5));
+}
+
+TEST_CASE("MemoCache"){
+  using namespace mem_comparable_closure;
+  call_counter = 0;
+  MemoCache<int, int> cache(2);
+
+  SUBCASE("hits"){
+    CHECK(cache(closure_from_fp(add).bind(2).as_fun(), 1) == 3);
+    // a new but identical closure
+    CHECK(cache(closure_from_fp(add).bind(2).as_fun(), 1) == 3);
+    CHECK(call_counter == 1);
+    CHECK(cache.get_hits() == 1);
+    CHECK(cache.get_misses() == 1);
+
+    // different argument
+    CHECK(cache(closure_from_fp(add).bind(2).as_fun(), 2) == 4);
+    // different closed value
+    CHECK(cache(closure_from_fp(add).bind(3).as_fun(), 1) == 4);
+    CHECK(call_counter == 3);
+    CHECK(cache.get_misses() == 3);
+    CHECK(cache.get_evictions() == 1);
+    CHECK(cache.get_size() == 2);
+  };
+
+  SUBCASE("least recently used"){
+    auto fun = closure_from_fp(add).bind(2).as_fun();
+    cache(fun, 1);
+    cache(fun, 2);
+    // 1 is now the most recently used
+    cache(fun, 1);
+    cache(fun, 3);
+    CHECK(call_counter == 3);
+    cache(fun, 1);
+    CHECK(call_counter == 3);
+    cache(fun, 2);
+    CHECK(call_counter == 4);
+  };
+
+  SUBCASE("memoize"){
+    auto memoized = memoize(closure_from_fp(add).bind(5).as_fun(), cache);
+    CHECK(memoized(1) == 6);
+    CHECK(memoized(1) == 6);
+    CHECK(call_counter == 1);
+    CHECK(cache.get_hits() == 1);
+  };
+}
@@ -109,3 +109,148 @@ TEST_CASE("struct" ){
   counter = 100;
   CHECK_FALSE(test_identical(struct1,struct3, counter));
 }
+
+struct Settings{
+  int width = 640;
+  int height = 480;
+  short depth = 24;
+  short flags = 0;
+  double scale = 1.0;
+  bool visible = true;
+  bool enabled = true;
+  char mode = 'a';
+  std::vector<int> ids = {1,2,3};
+  float opacity = 0.5;
+  unsigned int id = 7;
+  int layer = 0;
+  long stamp = 0;
+};
+
+struct PaddedAggregate{
+  char c;
+  int i;
+};
+
+struct AlignedAggregate{
+  int a;
+  alignas(8) int b;
+  int c;
+  long d;
+};
+
+TEST_CASE("aggregate" ){
+  using namespace mem_comparable_closure;
+
+  CHECK(concepts::is_aggregate_reflectable<Settings>::value);
+  CHECK(concepts::is_transparent<Settings>::value);
+  CHECK(reflection::field_count<Settings>() == 13);
+  // member accessible wins
+  CHECK_FALSE(concepts::is_aggregate_reflectable<myStruct>::value);
+
+  SUBCASE("coalesced"){
+    auto settings1 = Settings{};
+    auto settings2 = Settings{};
+    std::size_t counter = 100;
+    CHECK(test_identical(settings1,settings2, counter));
+    // 4 runs of trivial fields and 3 steps for the vector
+    //   instead of 15 steps field by field
+    CHECK(counter == 93);
+
+    settings2.mode = 'b';
+    counter = 100;
+    CHECK_FALSE(test_identical(settings1,settings2, counter));
+    settings2 = Settings{};
+    settings2.ids.push_back(4);
+    counter = 100;
+    CHECK_FALSE(test_identical(settings1,settings2, counter));
+    settings2 = Settings{};
+    settings2.stamp = 1;
+    counter = 100;
+    CHECK_FALSE(test_identical(settings1,settings2, counter));
+  };
+
+  SUBCASE("padding is not compared"){
+    alignas(PaddedAggregate) unsigned char buffer1[sizeof(PaddedAggregate)];
+    alignas(PaddedAggregate) unsigned char buffer2[sizeof(PaddedAggregate)];
+    std::memset(buffer1, 0x00, sizeof(buffer1));
+    std::memset(buffer2, 0xff, sizeof(buffer2));
+    auto padded1 = new (buffer1) PaddedAggregate{'a', 1};
+    auto padded2 = new (buffer2) PaddedAggregate{'a', 1};
+    std::size_t counter = 100;
+    CHECK(test_identical(*padded1, *padded2, counter));
+    padded2->i = 2;
+    counter = 100;
+    CHECK_FALSE(test_identical(*padded1, *padded2, counter));
+  };
+
+  SUBCASE("alignas"){
+    auto aligned1 = AlignedAggregate{1,2,3,4};
+    auto aligned2 = AlignedAggregate{1,2,3,4};
+    std::size_t counter = 100;
+    CHECK(test_identical(aligned1, aligned2, counter));
+    aligned2.b = 5;
+    counter = 100;
+    CHECK_FALSE(test_identical(aligned1, aligned2, counter));
+  };
+}
+
+struct myArrayStruct{
+  int values[3] = {1,2,3};
+  std::vector<int> lists[2] = {{1}, {2,3}};
+  decltype(auto) get_member_access()const{
+    return std::make_tuple(&(this->values),&(this->lists));
+  }
+};
+
+template<>
+struct mem_comparable_closure::concepts::is_member_accessible<myArrayStruct> : std::true_type{};
+
+TEST_CASE("array" ){
+  using namespace mem_comparable_closure;
+
+  // arrays of trivial elements are a single chunk
+  CHECK(concepts::is_trivial<int[3]>::value);
+  CHECK(concepts::is_trivial<std::array<double,4>>::value);
+  CHECK_FALSE(concepts::is_trivial<std::array<int,0>>::value);
+  CHECK(concepts::is_transparent<std::array<std::vector<int>,2>>::value);
+
+  SUBCASE("trivial"){
+    auto array1 = std::array<double,4>{1,2,3,4};
+    auto array2 = std::array<double,4>{1,2,3,4};
+    CHECK(is_identical(array1, array2));
+    array2[3] = 5;
+    CHECK(is_updated(array1, array2));
+  };
+
+  SUBCASE("non-trivial"){
+    using array_t = std::array<std::vector<int>,2>;
+    auto array1 = array_t{std::vector<int>{1}, std::vector<int>{2,3}};
+    auto array2 = array1;
+    CHECK(is_identical(array1, array2));
+    array2[1].push_back(4);
+    CHECK(is_updated(array1, array2));
+    CHECK(is_identical(std::array<std::vector<int>,0>{}, std::array<std::vector<int>,0>{}));
+  };
+
+  SUBCASE("members"){
+    auto struct1 = myArrayStruct{};
+    auto struct2 = myArrayStruct{};
+    CHECK(is_identical(struct1, struct2));
+    CHECK(structural_hash(struct1) == structural_hash(struct2));
+    struct2.values[2] = 4;
+    CHECK(is_updated(struct1, struct2));
+    struct2 = myArrayStruct{};
+    struct2.lists[0].push_back(1);
+    CHECK(is_updated(struct1, struct2));
+  };
+
+  SUBCASE("closed over"){
+    int (*fn)(std::array<std::vector<int>,2>, int) = [](std::array<std::vector<int>,2> lists, int i){
+      return lists[1][i];
+    };
+    auto closure1 = closure_from_fp(fn).bind(std::array<std::vector<int>,2>{std::vector<int>{1}, std::vector<int>{2,3}}).as_fun();
+    auto closure2 = closure_from_fp(fn).bind(std::array<std::vector<int>,2>{std::vector<int>{1}, std::vector<int>{2,3}}).as_fun();
+    CHECK(closure1(1) == 3);
+    CHECK(is_identical(closure1, closure2));
+  };
+}
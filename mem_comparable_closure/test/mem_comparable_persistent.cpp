@@ -0,0 +1,209 @@
+#include "doctest.h"
+#include "mem_comparable_persistent.hpp"
+#include "mem_comparable_vector.hpp"
+#include <cstdio>
+
+namespace {
+  int layout_calls = 0;
+
+  int layout(std::vector<int> widths, int gap){
+    ++layout_calls;
+    int result = 0;
+    for (int width : widths) result += width+gap;
+    return result;
+  };
+
+  int unregistered(int a){
+    return a;
+  };
+
+  int versioned(int a){
+    return a+1;
+  };
+
+  int next_version(int a){
+    return a+2;
+  };
+
+  const std::uint64_t layout_id = mem_comparable_closure::register_function(layout, "layout");
+
+  // overwrites the 64 bit value at offset in the file at path
+  void patch_file(const std::string& path, long offset, std::uint64_t value){
+    std::FILE* file = std::fopen(path.c_str(), "r+b");
+    std::fseek(file, offset, SEEK_SET);
+    std::fwrite(&value, sizeof(value), 1, file);
+    std::fclose(file);
+  };
+
+  // the layout of a cache file
+  constexpr long slot_count_offset = 16;
+  constexpr long slots_offset = 40;
+  constexpr long slot_size = 40;
+  constexpr long slot_offset_offset = 16;
+  constexpr long slot_is_used_offset = 32;
+
+  std::string temporary_path(){
+    char path[] = "/tmp/mem_comparable_cacheXXXXXX";
+    int fd = ::mkstemp(path);
+    ::close(fd);
+    std::remove(path);
+    return path;
+  };
+}
+
+TEST_CASE("stable_fingerprint"){
+  using namespace mem_comparable_closure;
+
+  CHECK(*FunctionRegistry::instance().find(reinterpret_cast<void(*)()>(layout)) == layout_id);
+  CHECK(register_function(layout, "layout") == layout_id);
+  CHECK_THROWS(register_function(layout, "another name"));
+  CHECK_THROWS(register_function(unregistered, "layout"));
+  // the version is part of the id
+  CHECK_THROWS(register_function(layout, "layout", 1));
+  const std::uint64_t versioned_id = register_function(versioned, "versioned", 1);
+  CHECK(register_function(next_version, "versioned", 2) != versioned_id);
+  CHECK_THROWS(register_function(next_version, "versioned", 1));
+
+  auto fun1 = closure_from_fp(layout).bind(std::vector<int>{1,2,3}).as_fun();
+  auto fun2 = closure_from_fp(layout).bind(std::vector<int>{1,2,3}).as_fun();
+  auto fun3 = closure_from_fp(layout).bind(std::vector<int>{1,2}).as_fun();
+  CHECK(stable_fingerprint(fun1) == stable_fingerprint(fun2));
+  CHECK(stable_fingerprint(fun1) != stable_fingerprint(fun3));
+  // does not depend on the address
+  CHECK(stable_fingerprint(fun1) != structural_hash(fun1));
+  CHECK_THROWS(stable_fingerprint(closure_from_fp(unregistered).as_fun()));
+  // comparisons still use the address
+  CHECK(is_identical(fun1, fun2));
+
+  CHECK(stable_key(fun1).fingerprint == stable_fingerprint(fun1));
+  CHECK(stable_key(fun1).verification == stable_key(fun2).verification);
+  CHECK(stable_key(fun1).verification != stable_key(fun3).verification);
+  CHECK(stable_key(fun1).verification != stable_key(fun1).fingerprint);
+}
+
+TEST_CASE("PersistentCache"){
+  using namespace mem_comparable_closure;
+  const std::string path = temporary_path();
+
+  SUBCASE("reopen"){
+    {
+      PersistentCache cache(path, 16);
+      CHECK(cache.store<int>({1, 1}, 42));
+      CHECK_FALSE(cache.store<int>({1, 1}, 43));
+      CHECK(cache.store({2, 2}, std::string("layout")));
+      CHECK(cache.get_size() == 2);
+    }
+    PersistentCache cache(path);
+    CHECK(cache.get_slot_count() == 16);
+    CHECK(cache.load<int>({1, 1}) == 42);
+    CHECK(cache.load<std::string>({2, 2}) == std::string("layout"));
+    CHECK_FALSE(cache.load<int>({3, 3}).has_value());
+  };
+
+  SUBCASE("verification"){
+    {
+      PersistentCache cache(path, 16);
+      CHECK(cache.store<int>({1, 11}, 42));
+      // the same fingerprint with another verification is another key
+      CHECK_FALSE(cache.load<int>({1, 12}).has_value());
+      CHECK(cache.store<int>({1, 12}, 43));
+    }
+    PersistentCache cache(path);
+    CHECK(cache.load<int>({1, 11}) == 42);
+    CHECK(cache.load<int>({1, 12}) == 43);
+    CHECK_FALSE(cache.load<int>({1, 13}).has_value());
+  };
+
+  SUBCASE("exclusive"){
+    {
+      PersistentCache cache(path, 16);
+      CHECK(cache.store<int>({1, 1}, 42));
+      // another cache on the same file fails instead of corrupting it
+      CHECK_THROWS_AS(PersistentCache{path}, std::system_error);
+      CHECK(cache.load<int>({1, 1}) == 42);
+    }
+    // the lock is released with the cache
+    PersistentCache cache(path);
+    CHECK(cache.load<int>({1, 1}) == 42);
+  };
+
+  SUBCASE("growth"){
+    PersistentCache cache(path, 64);
+    std::vector<int> large(100000, 7);
+    CHECK(cache.store({5, 5}, large));
+    CHECK(cache.store({6, 6}, std::vector<int>{1,2}));
+    CHECK(cache.load<std::vector<int>>({5, 5}) == large);
+    CHECK(cache.load<std::vector<int>>({6, 6}) == std::vector<int>{1,2});
+    // full at 3/4 of the slots
+    std::size_t inserted = 2;
+    while (cache.store<int>({100+inserted, 0}, 0)) ++inserted;
+    CHECK(inserted == 48);
+  };
+
+  SUBCASE("call_cached"){
+    auto fun = closure_from_fp(layout).bind(std::vector<int>{1,2,3}).as_fun();
+    layout_calls = 0;
+    {
+      PersistentCache cache(path);
+      CHECK(call_cached(cache, fun, 1) == 9);
+      CHECK(call_cached(cache, fun, 1) == 9);
+      CHECK(call_cached(cache, fun, 2) == 12);
+      CHECK(layout_calls == 2);
+    }
+    // the next run
+    PersistentCache cache(path);
+    auto new_fun = closure_from_fp(layout).bind(std::vector<int>{1,2,3}).as_fun();
+    CHECK(call_cached(cache, new_fun, 1) == 9);
+    CHECK(layout_calls == 2);
+  };
+
+  SUBCASE("corrupt header"){
+    {
+      PersistentCache cache(path, 16);
+    }
+    patch_file(path, slot_count_offset, 0);
+    CHECK_THROWS_AS(PersistentCache{path}, std::runtime_error);
+    // the size of the slots would overflow
+    patch_file(path, slot_count_offset, std::uint64_t(1) << 62);
+    CHECK_THROWS_AS(PersistentCache{path}, std::runtime_error);
+  };
+
+  SUBCASE("corrupt slots"){
+    {
+      PersistentCache cache(path, 16);
+      CHECK(cache.store<int>({1, 1}, 42));
+    }
+    // the slot of fingerprint 1 points behind the file
+    patch_file(path, slots_offset + 1*slot_size + slot_offset_offset, std::uint64_t(1) << 40);
+    {
+      PersistentCache cache(path);
+      CHECK_FALSE(cache.load<int>({1, 1}).has_value());
+      CHECK_FALSE(cache.store<int>({1, 1}, 43));
+    }
+    // every slot is used, a missing fingerprint is not probed forever
+    for (long k = 0; k< 16; ++k){
+      patch_file(path, slots_offset + k*slot_size + slot_is_used_offset, 1);
+    };
+    PersistentCache cache(path);
+    CHECK_FALSE(cache.load<int>({3, 3}).has_value());
+    CHECK_FALSE(cache.store<int>({3, 3}, 1));
+  };
+
+  SUBCASE("serializable"){
+    struct Padded{ char a; int b; };
+    struct Pointer{ const int* a; };
+    CHECK(detail::is_serializable_as_bytes<int>);
+    CHECK(detail::is_serializable_as_bytes<double>);
+    CHECK_FALSE(detail::is_serializable_as_bytes<Padded>);
+    CHECK_FALSE(detail::is_serializable_as_bytes<Pointer>);
+    CHECK_FALSE(detail::is_serializable_as_bytes<const int*>);
+  };
+
+  SUBCASE("not a cache file"){
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    std::fputs("something else entirely, but long enough to hold a header", file);
+    std::fclose(file);
+    CHECK_THROWS(PersistentCache{path});
+  };
+  std::remove(path.c_str());
+}
@@ -0,0 +1,93 @@
+#include "doctest.h"
+#include "mem_comparable_pointer.hpp"
+#include "mem_comparable_snapshot.hpp"
+#include "mem_comparable_vector.hpp"
+
+namespace {
+  struct Model{
+    static int visits;
+    std::vector<int> rows;
+    std::tuple<const std::vector<int>*> get_member_access()const{
+      ++visits;
+      return std::tuple<const std::vector<int>*>(&(this->rows));
+    };
+  };
+  int Model::visits = 0;
+
+  std::size_t row_count(std::shared_ptr<const Model> model){
+    return model ? model->rows.size() : 0;
+  };
+
+  // a move only value is closed over by a const reference
+  std::size_t count_above(const std::unique_ptr<const std::vector<int>>& values, int threshold){
+    std::size_t count = 0;
+    for (int value : *values) count += value > threshold ? 1 : 0;
+    return count;
+  };
+}
+
+template<>
+struct mem_comparable_closure::concepts::is_member_accessible<Model> : std::true_type{};
+
+TEST_CASE("shared_ptr"){
+  using namespace mem_comparable_closure;
+  using pointer_t = std::shared_ptr<const Model>;
+
+  CHECK(concepts::is_transparent<pointer_t>::value);
+  // the pointee of a pointer to non-const could change
+  CHECK_FALSE(concepts::is_transparent<std::shared_ptr<Model>>::value);
+
+  auto model = std::make_shared<const Model>(Model{{1,2,3}});
+  auto fun1 = closure_from_fp(row_count).bind(model).as_fun();
+
+  SUBCASE("same object"){
+    auto fun2 = closure_from_fp(row_count).bind(model).as_fun();
+    Model::visits = 0;
+    CHECK(is_identical(fun1, fun2));
+    CHECK(Model::visits == 0);
+  };
+
+  SUBCASE("equal copy"){
+    auto fun2 = closure_from_fp(row_count).bind(std::make_shared<const Model>(Model{{1,2,3}})).as_fun();
+    Model::visits = 0;
+    CHECK(is_identical(fun1, fun2));
+    CHECK(Model::visits == 2);
+    CHECK(structural_hash(fun1) == structural_hash(fun2));
+    CHECK(is_identical(snapshot(fun1), fun2));
+  };
+
+  SUBCASE("updated"){
+    auto fun2 = closure_from_fp(row_count).bind(std::make_shared<const Model>(Model{{1,2}})).as_fun();
+    CHECK(is_updated(fun1, fun2));
+    auto fun3 = closure_from_fp(row_count).bind(pointer_t{}).as_fun();
+    CHECK(is_updated(fun1, fun3));
+    CHECK(fun3() == 0);
+    CHECK(is_identical(fun3, closure_from_fp(row_count).bind(pointer_t{}).as_fun()));
+  };
+}
+
+TEST_CASE("unique_ptr"){
+  using namespace mem_comparable_closure;
+  using pointer_t = std::unique_ptr<const std::vector<int>>;
+
+  CHECK(concepts::is_transparent<pointer_t>::value);
+  pointer_t ptr1(new std::vector<int>{1,2});
+  pointer_t ptr2(new std::vector<int>{1,2});
+  CHECK(is_identical(ptr1, ptr1));
+  CHECK(is_identical(ptr1, ptr2));
+  CHECK(is_updated(ptr1, pointer_t{}));
+  CHECK(is_updated(ptr1, pointer_t(new std::vector<int>{1})));
+
+  SUBCASE("closed over"){
+    // the Closures are moved through bind and as_fun
+    auto fun1 = closure_from_fp(count_above).bind(std::make_unique<const std::vector<int>>(std::vector<int>{1,2,3})).as_fun();
+    auto fun2 = closure_from_fp(count_above).bind(std::make_unique<const std::vector<int>>(std::vector<int>{1,2,3})).as_fun();
+    auto fun3 = closure_from_fp(count_above).bind(std::make_unique<const std::vector<int>>(std::vector<int>{1,2})).as_fun();
+    CHECK(fun1(1) == 2);
+    CHECK(is_identical(fun1, fun2));
+    CHECK(fun1.get_fingerprint() == fun2.get_fingerprint());
+    CHECK(is_updated(fun1, fun3));
+    auto closure = closure_from_fp(count_above).bind(std::make_unique<const std::vector<int>>(std::vector<int>{1,2,3}));
+    CHECK(is_identical(std::move(closure).as_fun(), fun1));
+  };
+}
@@ -0,0 +1,62 @@
+#include "doctest.h"
+#include "mem_comparable_scheduler.hpp"
+
+namespace {
+  std::atomic<int> call_counter{0};
+
+  int square(int a){
+    ++call_counter;
+    return a*a;
+  };
+
+  std::vector<mem_comparable_closure::Function<int>> make_nodes(std::vector<int> values){
+    using namespace mem_comparable_closure;
+    std::vector<Function<int>> nodes;
+    for (int value : values){
+      nodes.push_back(closure_from_fp(square).bind(value).as_fun());
+    };
+    return nodes;
+  };
+}
+
+TEST_CASE("WorkStealingPool"){
+  using namespace mem_comparable_closure;
+  WorkStealingPool pool(3);
+  CHECK(pool.get_worker_count() == 3);
+
+  SUBCASE("every index once"){
+    std::vector<std::atomic<int>> visited(1000);
+    pool.parallel_for(visited.size(), [&](std::size_t i){ ++visited[i]; });
+    bool all_once = true;
+    for (auto& v : visited) all_once = all_once and v == 1;
+    CHECK(all_once);
+    // the pool is reusable
+    pool.parallel_for(visited.size(), [&](std::size_t i){ ++visited[i]; });
+    CHECK(visited[999] == 2);
+  };
+
+  SUBCASE("exception"){
+    CHECK_THROWS(pool.parallel_for(10, [](std::size_t i){ if (i == 7) throw std::runtime_error("7"); }));
+  };
+
+  SUBCASE("empty"){
+    pool.parallel_for(0, [](std::size_t ){ });
+  };
+}
+
+TEST_CASE("IncrementalEvaluator"){
+  using namespace mem_comparable_closure;
+  WorkStealingPool pool(2);
+  IncrementalEvaluator<int> evaluator(pool);
+  call_counter = 0;
+
+  CHECK(evaluator.evaluate(make_nodes({1,2,3})) == std::vector<int>{1,4,9});
+  CHECK(evaluator.get_invoked_count() == 3);
+
+  CHECK(evaluator.evaluate(make_nodes({1,5,3,4})) == std::vector<int>{1,25,9,16});
+  CHECK(evaluator.get_invoked_count() == 2);
+  CHECK(call_counter == 5);
+
+  CHECK(evaluator.evaluate(make_nodes({1,5})) == std::vector<int>{1,25});
+  CHECK(evaluator.get_invoked_count() == 0);
+}
@@ -0,0 +1,104 @@
+#include "doctest.h"
+#include "mem_comparable_slot.hpp"
+#include <thread>
+#include <vector>
+
+namespace {
+  int add(int a, int b){
+    return a+b;
+  };
+}
+
+TEST_CASE("ClosureSlot"){
+  using namespace mem_comparable_closure;
+  ClosureSlot<int, int> slot;
+  CHECK_FALSE(static_cast<bool>(slot.load()));
+  CHECK(slot.get_generation() == 0);
+
+  SUBCASE("publish"){
+    CHECK(slot.publish(closure_from_fp(add).bind(1).as_fun()));
+    CHECK(slot.get_generation() == 1);
+    // identical
+    CHECK_FALSE(slot.publish(closure_from_fp(add).bind(1).as_fun()));
+    CHECK(slot.get_generation() == 1);
+    auto loaded = slot.load();
+    CHECK(slot.publish(closure_from_fp(add).bind(2).as_fun()));
+    CHECK(slot.get_generation() == 2);
+    // the old Function is still alive
+    CHECK((*loaded)(1) == 2);
+    CHECK((*slot.load())(1) == 3);
+  };
+
+  SUBCASE("load_if_changed"){
+    std::uint64_t seen_generation = 0;
+    ClosureSlot<int, int>::pointer_t fun;
+    CHECK_FALSE(slot.load_if_changed(seen_generation, fun));
+    slot.publish(closure_from_fp(add).bind(1).as_fun());
+    CHECK(slot.load_if_changed(seen_generation, fun));
+    CHECK((*fun)(1) == 2);
+    CHECK_FALSE(slot.load_if_changed(seen_generation, fun));
+  };
+
+  SUBCASE("threads"){
+    std::thread producer([&slot](){
+      for (int i = 0; i< 1000; ++i){
+	slot.publish(closure_from_fp(add).bind(i/10).as_fun());
+      };
+    });
+    std::uint64_t seen_generation = 0;
+    ClosureSlot<int, int>::pointer_t fun;
+    int last = -1;
+    bool monotonic = true;
+    bool consistent = true;
+    while (last < 99){
+      if (slot.load_if_changed(seen_generation, fun)){
+	int value = (*fun)(0);
+	monotonic = monotonic and value >= last;
+	// the value i is published as generation i+1
+	consistent = consistent and seen_generation == static_cast<std::uint64_t>(value + 1);
+	last = value;
+      };
+    };
+    producer.join();
+    CHECK(monotonic);
+    CHECK(consistent);
+    CHECK(slot.get_generation() == 100);
+  };
+
+  SUBCASE("producers"){
+    // the generation counter never goes back, even if publishes finish out of order
+    std::atomic<int> published{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p< 4; ++p){
+      producers.emplace_back([&slot, &published, p](){
+	for (int i = 0; i< 500; ++i){
+	  if (slot.publish(closure_from_fp(add).bind(4*i+p).as_fun())) ++published;
+	};
+      });
+    };
+    std::uint64_t last = 0;
+    bool monotonic = true;
+    for (int i = 0; i< 10000; ++i){
+      const std::uint64_t generation = slot.get_generation();
+      monotonic = monotonic and generation >= last;
+      last = generation;
+    };
+    for (auto& producer : producers) producer.join();
+    CHECK(monotonic);
+    CHECK(slot.get_generation() == static_cast<std::uint64_t>(published.load()));
+    std::uint64_t seen_generation = 0;
+    ClosureSlot<int, int>::pointer_t fun;
+    CHECK(slot.load_if_changed(seen_generation, fun));
+    CHECK(seen_generation == slot.get_generation());
+  };
+
+  SUBCASE("constructed with a Function"){
+    ClosureSlot<int, int> full(closure_from_fp(add).bind(1).as_fun());
+    CHECK(full.get_generation() == 1);
+    std::uint64_t seen_generation = 0;
+    ClosureSlot<int, int>::pointer_t fun;
+    CHECK(full.load_if_changed(seen_generation, fun));
+    CHECK(seen_generation == 1);
+    CHECK((*fun)(1) == 2);
+  };
+}
@@ -0,0 +1,39 @@
+#include "doctest.h"
+#include "mem_comparable_snapshot.hpp"
+#include "mem_comparable_vector.hpp"
+
+namespace {
+  int sum(std::vector<int> values, int offset){
+    int result = offset;
+    for (int value : values) result += value;
+    return result;
+  };
+}
+
+TEST_CASE("Snapshot"){
+  using namespace mem_comparable_closure;
+  using function_t = Function<int, int>;
+
+  auto old_snapshot = [](){
+    // the closure is gone after the snapshot is taken
+    auto fun = closure_from_fp(sum).bind(std::vector<int>{1,2,3}).as_fun();
+    return snapshot(fun);
+  }();
+
+  auto identical = closure_from_fp(sum).bind(std::vector<int>{1,2,3}).as_fun();
+  auto updated = closure_from_fp(sum).bind(std::vector<int>{1,2,4}).as_fun();
+  auto longer = closure_from_fp(sum).bind(std::vector<int>{1,2,3,4}).as_fun();
+
+  CHECK(is_identical(old_snapshot, identical));
+  CHECK(is_identical(identical, old_snapshot));
+  CHECK(is_updated(old_snapshot, updated));
+  CHECK(is_updated(old_snapshot, longer));
+  CHECK(old_snapshot.get_hash() == structural_hash(identical));
+  CHECK(std::is_same<decltype(old_snapshot), Snapshot<function_t>>::value);
+
+  SUBCASE("trivial"){
+    auto snapshot1 = snapshot(5);
+    CHECK(is_identical(snapshot1, 5));
+    CHECK(is_updated(snapshot1, 6));
+  };
+}
@@ -0,0 +1,52 @@
+#include "doctest.h"
+#include "mem_comparable_string.hpp"
+#include "mem_comparable_snapshot.hpp"
+
+namespace {
+  std::size_t label_length(std::string label, int offset){
+    return label.size()+offset;
+  };
+}
+
+TEST_CASE("string"){
+  using namespace mem_comparable_closure;
+
+  CHECK(concepts::is_transparent<std::string>::value);
+  CHECK(concepts::is_transparent<std::wstring>::value);
+  CHECK(concepts::is_transparent<std::string_view>::value);
+
+  SUBCASE("short"){
+    CHECK(is_identical(std::string("label"), std::string("label")));
+    CHECK(is_updated(std::string("label"), std::string("lapel")));
+    CHECK(is_updated(std::string("label"), std::string("labels")));
+    CHECK(is_identical(std::string(), std::string()));
+    CHECK(structural_hash(std::string("label")) == structural_hash(std::string("label")));
+  };
+
+  SUBCASE("long"){
+    std::string long1(100, 'x');
+    std::string long2(100, 'x');
+    CHECK(is_identical(long1, long2));
+    long2[99] = 'y';
+    CHECK(is_updated(long1, long2));
+    CHECK(structural_hash(long1) != structural_hash(long2));
+    // a short prefix
+    CHECK(is_updated(long1, std::string(10, 'x')));
+  };
+
+  SUBCASE("string_view"){
+    std::string text = "a label and another label";
+    CHECK(is_identical(std::string_view(text).substr(2, 5), std::string_view("label")));
+    CHECK(is_updated(std::string_view(text).substr(2, 5), std::string_view("lapel")));
+  };
+
+  SUBCASE("closed over"){
+    auto closure1 = closure_from_fp(label_length).bind(std::string("a long label which is not short")).as_fun();
+    auto closure2 = closure_from_fp(label_length).bind(std::string("a long label which is not short")).as_fun();
+    auto closure3 = closure_from_fp(label_length).bind(std::string("short")).as_fun();
+    CHECK(closure3(1) == 6);
+    CHECK(is_identical(closure1, closure2));
+    CHECK(is_updated(closure1, closure3));
+    CHECK(is_identical(snapshot(closure1), closure2));
+  };
+}
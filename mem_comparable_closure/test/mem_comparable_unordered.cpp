@@ -0,0 +1,77 @@
+#include "doctest.h"
+#include "mem_comparable_unordered.hpp"
+#include "mem_comparable_string.hpp"
+#include "mem_comparable_vector.hpp"
+
+namespace {
+  bool is_selected(std::unordered_set<int> selection, int id){
+    return selection.count(id) > 0;
+  };
+}
+
+TEST_CASE("unordered_set"){
+  using namespace mem_comparable_closure;
+  using set_t = std::unordered_set<int>;
+
+  CHECK(concepts::is_transparent<set_t>::value);
+
+  set_t set1;
+  set_t set2;
+  for (int i = 0; i< 100; ++i) set1.insert(i);
+  // a different insertion order and bucket count
+  set2.reserve(1000);
+  for (int i = 99; i>= 0; --i) set2.insert(i);
+
+  CHECK(is_identical(set1, set2));
+  CHECK(structural_hash(set1) == structural_hash(set2));
+  set2.erase(50);
+  CHECK(is_updated(set1, set2));
+  set2.insert(100);
+  CHECK(is_updated(set1, set2));
+  CHECK(is_identical(set_t{}, set_t{}));
+
+  SUBCASE("canonical order"){
+    // orders elements with colliding hashes
+    algorithm::IteratorStack stack1;
+    algorithm::IteratorStack stack2;
+    using vector_t = std::vector<int>;
+    CHECK(algorithm::compare_chunk_streams(vector_t{1,2}, vector_t{1,2}, stack1, stack2) == 0);
+    const int order = algorithm::compare_chunk_streams(vector_t{1,2}, vector_t{1,3}, stack1, stack2);
+    CHECK(order != 0);
+    const int reverse_order = algorithm::compare_chunk_streams(vector_t{1,3}, vector_t{1,2}, stack1, stack2);
+    CHECK(reverse_order != 0);
+    CHECK((order < 0) != (reverse_order < 0));
+    CHECK(algorithm::compare_chunk_streams(vector_t{1}, vector_t{1,2}, stack1, stack2) != 0);
+    // the stacks are empty again
+    CHECK(stack1.get_size() == 0);
+    CHECK(stack2.get_size() == 0);
+  };
+
+  SUBCASE("closed over"){
+    auto closure1 = closure_from_fp(is_selected).bind(set_t{1,2,3}).as_fun();
+    auto closure2 = closure_from_fp(is_selected).bind(set_t{3,2,1}).as_fun();
+    auto closure3 = closure_from_fp(is_selected).bind(set_t{1,2}).as_fun();
+    CHECK(closure1(2));
+    CHECK(is_identical(closure1, closure2));
+    CHECK(is_updated(closure1, closure3));
+  };
+}
+
+TEST_CASE("unordered_map"){
+  using namespace mem_comparable_closure;
+  using map_t = std::unordered_map<std::string, std::vector<int>>;
+
+  CHECK(concepts::is_transparent<map_t>::value);
+
+  map_t map1{{"a", {1}}, {"b", {2,3}}, {"c", {}}};
+  map_t map2{{"c", {}}, {"b", {2,3}}, {"a", {1}}};
+  CHECK(is_identical(map1, map2));
+  map2["b"].push_back(4);
+  CHECK(is_updated(map1, map2));
+
+  SUBCASE("multimap"){
+    using multimap_t = std::unordered_multimap<int, int>;
+    CHECK(is_identical(multimap_t{{1,1},{1,2},{2,1}}, multimap_t{{2,1},{1,2},{1,1}}));
+    CHECK(is_updated(multimap_t{{1,1},{1,2}}, multimap_t{{1,1},{1,1}}));
+  };
+}
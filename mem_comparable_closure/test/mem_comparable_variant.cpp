@@ -0,0 +1,53 @@
+#include "doctest.h"
+#include "mem_comparable_variant.hpp"
+#include "mem_comparable_vector.hpp"
+
+namespace {
+  struct MyIntransparentStruct{};
+
+  int count(std::variant<int, std::vector<int>> value){
+    if (auto list = std::get_if<1>(&value)) return static_cast<int>(list->size());
+    return 1;
+  };
+}
+
+TEST_CASE("optional"){
+  using namespace mem_comparable_closure;
+  using optional_t = std::optional<std::vector<int>>;
+
+  CHECK(concepts::is_transparent<optional_t>::value);
+  CHECK(concepts::is_transparent<std::optional<int>>::value);
+  CHECK_FALSE(concepts::is_transparent<std::optional<MyIntransparentStruct>>::value);
+
+  CHECK(is_identical(optional_t{}, optional_t{}));
+  CHECK(is_identical(optional_t{std::vector<int>{1,2}}, optional_t{std::vector<int>{1,2}}));
+  CHECK(is_updated(optional_t{}, optional_t{std::vector<int>{}}));
+  CHECK(is_updated(optional_t{std::vector<int>{1,2}}, optional_t{std::vector<int>{1,3}}));
+  CHECK(is_identical(std::optional<int>{5}, std::optional<int>{5}));
+  CHECK(is_updated(std::optional<int>{5}, std::optional<int>{}));
+  CHECK(structural_hash(optional_t{}) != structural_hash(optional_t{std::vector<int>{}}));
+}
+
+TEST_CASE("variant"){
+  using namespace mem_comparable_closure;
+  using variant_t = std::variant<int, std::vector<int>>;
+
+  CHECK(concepts::is_transparent<variant_t>::value);
+  CHECK_FALSE(concepts::is_transparent<std::variant<int, MyIntransparentStruct>>::value);
+
+  CHECK(is_identical(variant_t{1}, variant_t{1}));
+  CHECK(is_updated(variant_t{1}, variant_t{2}));
+  CHECK(is_identical(variant_t{std::vector<int>{1}}, variant_t{std::vector<int>{1}}));
+  CHECK(is_updated(variant_t{std::vector<int>{1}}, variant_t{std::vector<int>{2}}));
+  // the same bytes in different alternatives
+  CHECK(is_updated(std::variant<int, unsigned int>{1}, std::variant<int, unsigned int>{1u}));
+
+  SUBCASE("closed over"){
+    auto closure1 = closure_from_fp(count).bind(variant_t{std::vector<int>{1,2}}).as_fun();
+    auto closure2 = closure_from_fp(count).bind(variant_t{std::vector<int>{1,2}}).as_fun();
+    auto closure3 = closure_from_fp(count).bind(variant_t{2}).as_fun();
+    CHECK(closure1() == 2);
+    CHECK(is_identical(closure1, closure2));
+    CHECK(is_updated(closure1, closure3));
+  };
+}
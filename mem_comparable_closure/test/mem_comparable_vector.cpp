@@ -1,5 +1,6 @@
 #include "doctest.h"
 #include "mem_comparable_vector.hpp"
+#include <cstring>
 
 
 
@@ -16,6 +17,215 @@ TEST_CASE("vector" ){
   auto stack = algorithm::IteratorStack{};
   algorithm::get_mem_compare_info(&vec,nullptr,nullptr, stack);
 
+  SUBCASE("closed over"){
+    int (*fn)(std::vector<int>, int) = [](std::vector<int> vec, int i){ return vec[i];};
+    auto closure1 = closure_from_fp(fn).bind(std::vector<int>{1,2,3}).as_fun();
+    auto closure2 = closure_from_fp(fn).bind(std::vector<int>{1,2,3}).as_fun();
+    auto closure3 = closure_from_fp(fn).bind(std::vector<int>{1,2,4}).as_fun();
+    auto closure4 = closure_from_fp(fn).bind(std::vector<int>{1,2}).as_fun();
+    CHECK(closure1(2) == 3);
+    CHECK(is_identical(closure1, closure2));
+    CHECK(is_updated(closure1, closure3));
+    CHECK(is_updated(closure1, closure4));
+  };
+}
+
+namespace {
+  // 7 bytes of fields, 12 bytes with padding
+  struct MyPaddedElement{
+    char tag;
+    int value;
+    short weight;
+  };
+
+  std::vector<MyPaddedElement> make_elements(std::size_t size, unsigned char padding){
+    std::vector<MyPaddedElement> elements(size);
+    // garbage in the padding
+    if (size > 0) std::memset(static_cast<void*>(elements.data()), padding, size*sizeof(MyPaddedElement));
+    for (std::size_t i = 0; i< size; ++i){
+      elements[i].tag = 'a';
+      elements[i].value = static_cast<int>(i);
+      elements[i].weight = 1;
+    };
+    return elements;
+  };
+
+  // compared through its members, padding included in the object
+  class MyMemberElement{
+  public:
+    MyMemberElement() = default;
+    MyMemberElement(char tag, double value):tag(tag), value(value){};
+    std::tuple<const char*, const double*> get_member_access()const{
+      return std::tuple<const char*, const double*>(&(this->tag), &(this->value));
+    };
+  private:
+    char tag = 0;
+    double value = 0;
+  };
+
+  class MyNestedMemberElement{
+  public:
+    std::tuple<const std::vector<int>*> get_member_access()const{
+      return std::tuple<const std::vector<int>*>(&(this->values));
+    };
+  private:
+    std::vector<int> values;
+  };
+
+  std::vector<MyMemberElement> make_member_elements(std::size_t size, unsigned char padding){
+    std::vector<MyMemberElement> elements(size);
+    if (size > 0) std::memset(static_cast<void*>(elements.data()), padding, size*sizeof(MyMemberElement));
+    for (std::size_t i = 0; i< size; ++i){
+      elements[i] = MyMemberElement('m', static_cast<double>(i));
+    };
+    return elements;
+  };
+}
+
+template<>
+struct ::mem_comparable_closure::concepts::is_member_accessible<MyMemberElement> : std::true_type{};
+template<>
+struct ::mem_comparable_closure::concepts::is_member_accessible<MyNestedMemberElement> : std::true_type{};
+
+TEST_CASE("vector of flat elements" ){
+  using namespace mem_comparable_closure;
+
+  CHECK(concepts::is_flat<MyPaddedElement>::value);
+  CHECK_FALSE(concepts::is_flat<std::vector<int>>::value);
+
+  SUBCASE("blocks"){
+    // 4096/7 elements per block
+    for (std::size_t size : {0, 1, 585, 586, 10000}){
+      CHECK(is_identical(make_elements(size, 0), make_elements(size, 0xff)));
+      CHECK(structural_hash(make_elements(size, 0)) == structural_hash(make_elements(size, 0xff)));
+      CHECK(is_updated(make_elements(size, 0), make_elements(size+1, 0)));
+    };
+  };
+
+  SUBCASE("different"){
+    auto elements = make_elements(10000, 0);
+    for (std::size_t i : {0, 584, 585, 586, 9999}){
+      auto changed = make_elements(10000, 0);
+      changed[i].weight = 2;
+      CHECK(is_updated(elements, changed));
+    };
+  };
+
+  SUBCASE("member_accessible"){
+    CHECK(concepts::is_flat<MyMemberElement>::value);
+    CHECK_FALSE(concepts::is_flat<MyNestedMemberElement>::value);
+    // 4096/9 elements per block
+    for (std::size_t size : {0, 1, 455, 456, 10000}){
+      CHECK(is_identical(make_member_elements(size, 0), make_member_elements(size, 0xff)));
+      CHECK(structural_hash(make_member_elements(size, 0)) == structural_hash(make_member_elements(size, 0xff)));
+      CHECK(is_updated(make_member_elements(size, 0), make_member_elements(size+1, 0)));
+    };
+    auto elements = make_member_elements(10000, 0);
+    for (std::size_t i : {0, 454, 455, 456, 9999}){
+      auto changed = make_member_elements(10000, 0);
+      changed[i] = MyMemberElement('n', static_cast<double>(i));
+      CHECK(is_updated(elements, changed));
+    };
+  };
+
+  SUBCASE("nested"){
+    using nested_t = std::vector<std::vector<MyPaddedElement>>;
+    CHECK(is_identical(nested_t{make_elements(3, 0), make_elements(700, 0)},
+		       nested_t{make_elements(3, 1), make_elements(700, 2)}));
+    CHECK(is_updated(nested_t{make_elements(3, 0), make_elements(700, 0)},
+		     nested_t{make_elements(3, 0), make_elements(701, 0)}));
+  };
+}
+
+TEST_CASE("vector<bool>" ){
+  using namespace mem_comparable_closure;
+
+  auto make_bits = [](std::size_t size, std::size_t flipped){
+    std::vector<bool> bits(size);
+    for (std::size_t i = 0; i< size; i+=3) bits[i] = true;
+    if (flipped < size) bits[flipped] = not bits[flipped];
+    return bits;
+  };
+  constexpr std::size_t none = static_cast<std::size_t>(-1);
+
+  SUBCASE("sizes"){
+    for (std::size_t size : {0, 1, 63, 64, 65, 200}){
+      CHECK(is_identical(make_bits(size, none), make_bits(size, none)));
+      CHECK(is_updated(make_bits(size, none), make_bits(size+1, none)));
+    };
+  };
+
+  SUBCASE("last partial word"){
+    CHECK(is_updated(make_bits(130, none), make_bits(130, 129)));
+    CHECK(is_updated(make_bits(130, none), make_bits(130, 5)));
+  };
+
+  SUBCASE("unused bits are masked"){
+    auto bits1 = make_bits(70, none);
+    auto bits2 = make_bits(71, 70);
+    bits2.pop_back();
+    CHECK(is_identical(bits1, bits2));
+  };
+
+  SUBCASE("closed over"){
+    bool (*fn)(std::vector<bool>, int) = [](std::vector<bool> flags, int i)->bool{ return flags[i];};
+    auto closure1 = closure_from_fp(fn).bind(make_bits(100, none)).as_fun();
+    auto closure2 = closure_from_fp(fn).bind(make_bits(100, none)).as_fun();
+    auto closure3 = closure_from_fp(fn).bind(make_bits(100, 99)).as_fun();
+    CHECK(closure1(3));
+    CHECK(is_identical(closure1, closure2));
+    CHECK(is_updated(closure1, closure3));
+  };
+}
+
+TEST_CASE("Comparator" ){
+  using namespace mem_comparable_closure;
+
+  auto vec1 = std::vector<int>(1000, 1);
+  auto vec2 = std::vector<int>(1000, 1);
+
+  SUBCASE("identical"){
+    Comparator<std::vector<int>> comparator(vec1, vec2);
+    std::size_t steps = 0;
+    while (comparator.step(100) == ComparisonState::more_work) ++steps;
+    CHECK(comparator.get_state() == ComparisonState::identical);
+    // 8 bytes of size and 4000 bytes of content
+    CHECK(steps == 40);
+  };
+
+  SUBCASE("different"){
+    vec2[900] = 2;
+    Comparator<std::vector<int>> comparator(vec1, vec2);
+    std::size_t steps = 0;
+    while (comparator.step(100) == ComparisonState::more_work) ++steps;
+    CHECK(comparator.get_state() == ComparisonState::different);
+    CHECK(steps == 36);
+    // the result stays
+    CHECK(comparator.step(100) == ComparisonState::different);
+  };
+
+  SUBCASE("resumes within a chunk"){
+    // a budget that doesn't divide the element size splits the chunk
+    //   mid element, so every step has to pick up the saved offset
+    vec2[999] = 2;
+    Comparator<std::vector<int>> comparator(vec1, vec2);
+    std::size_t steps = 0;
+    while (comparator.step(7) == ComparisonState::more_work) ++steps;
+    CHECK(comparator.get_state() == ComparisonState::different);
+    CHECK(steps == 572);
+  };
 
+  SUBCASE("no budget"){
+    Comparator<std::vector<int>> comparator(vec1, vec2);
+    std::size_t steps = 0;
+    while (comparator.step(0) == ComparisonState::more_work) ++steps;
+    CHECK(comparator.get_state() == ComparisonState::identical);
+    // a chunk per step: the size, then the content
+    CHECK(steps == 1);
+  };
 
+  SUBCASE("unlimited"){
+    Comparator<std::vector<int>> comparator(vec1, vec2);
+    CHECK(comparator.step(std::numeric_limits<std::size_t>::max()) == ComparisonState::identical);
+  };
 }